@@ -0,0 +1,473 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <pthread.h>
+
+#include "hashids.h"
+#include "decimal.h"
+
+#ifndef lengthof
+#define lengthof(x) ((size_t)(sizeof(x) / sizeof(x[0])))
+#endif
+
+/* inputs pre-generated per case (decode cycles through their hashes) */
+#define BENCH_POOL_SIZE 1024
+
+/* longest tuple we benchmark */
+#define BENCH_MAX_NUMBERS 16
+
+enum { FORMAT_JSON = 0, FORMAT_CSV = 1 };
+enum { OPERATION_ENCODE = 0, OPERATION_DECODE = 1 };
+
+static const char *operation_names[] = {"encode", "decode"};
+
+/* a benchmark case */
+struct bench_case_s {
+    const char *dimension;
+    size_t salt_length;
+    size_t alphabet_length;
+    size_t min_hash_length;
+    size_t numbers_count;
+    unsigned long long magnitude;
+    size_t threads;
+};
+
+/* per-thread state */
+struct bench_thread_s {
+    pthread_t thread;
+    const struct bench_case_s *bench_case;
+    int operation;
+    size_t iterations;
+    unsigned long long seed;
+    unsigned long long *latencies;
+    unsigned long long started, finished;
+    int error;
+};
+
+/* the sweeps: every dimension is varied around the baseline */
+static const unsigned long long magnitudes[] = {
+    10ull, 1000000ull, 1000000000000ull, 18446744073709551615ull
+};
+static const size_t numbers_counts[] = {1, 2, 4, 8, 16};
+static const size_t alphabet_lengths[] = {16, 32, 62, 90};
+static const size_t salt_lengths[] = {0, 8, 32, 128};
+static const size_t min_hash_lengths[] = {0, 8, 32, 64};
+static const size_t threads_counts[] = {1, 2, 4, 8};
+
+static const struct bench_case_s baseline = {
+    "baseline", 16, 62, 0, 1, 1000000000000ull, 1
+};
+
+static void
+usage(const char *program_invocation_name, FILE *out)
+{
+    fputs("\n", out);
+    fputs("Usage:\n", out);
+    fprintf(out, "  %s [options]\n", program_invocation_name);
+
+    fputs("\n", out);
+    fputs("Options:\n", out);
+    fputs("  -f, --format      output format: json (default) or csv\n", out);
+    fputs("  -n, --iterations  operations per thread and case [200000]\n",
+        out);
+    fputs("  -d, --decimal     compare the CLI decimal routines with libc\n",
+        out);
+    fputs("  -h, --help        display this help and exit\n", out);
+    fputs("  -v, --version     print version information and exit\n", out);
+
+    fputs("\n", out);
+    exit(out == stderr ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/* xorshift64* */
+static unsigned long long
+bench_random(unsigned long long *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ull;
+}
+
+static unsigned long long
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int
+bench_compare(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *)a,
+        y = *(const unsigned long long *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* instance for a case; alphabets are slices of the printable ASCII range */
+static hashids_t *
+bench_hashids(const struct bench_case_s *bench_case)
+{
+    char salt[256], alphabet[256];
+    size_t i;
+
+    for (i = 0; i < bench_case->salt_length; ++i) {
+        salt[i] = 'a' + i % 26;
+    }
+    salt[i] = '\0';
+
+    for (i = 0; i < bench_case->alphabet_length; ++i) {
+        alphabet[i] = '!' + i;
+    }
+    alphabet[i] = '\0';
+
+    return hashids_init3(salt, bench_case->min_hash_length, alphabet);
+}
+
+static void *
+bench_thread(void *arg)
+{
+    struct bench_thread_s *state = arg;
+    const struct bench_case_s *bench_case = state->bench_case;
+    unsigned long long *numbers, decoded[BENCH_MAX_NUMBERS], started;
+    hashids_t *hashids;
+    char *hashes;
+    size_t i, k, hash_size;
+
+    hashids = bench_hashids(bench_case);
+    numbers = calloc(BENCH_POOL_SIZE * bench_case->numbers_count,
+        sizeof(unsigned long long));
+    hash_size = bench_case->min_hash_length + 16
+        + bench_case->numbers_count * 24;
+    hashes = calloc(BENCH_POOL_SIZE, hash_size);
+
+    if (!hashids || !numbers || !hashes) {
+        state->error = 1;
+        goto cleanup;
+    }
+
+    /* generate the input pool */
+    for (i = 0; i < BENCH_POOL_SIZE * bench_case->numbers_count; ++i) {
+        numbers[i] = bench_random(&state->seed);
+        if (bench_case->magnitude != 18446744073709551615ull) {
+            numbers[i] %= bench_case->magnitude + 1;
+        }
+    }
+    for (i = 0; i < BENCH_POOL_SIZE; ++i) {
+        hashids_encode(hashids, hashes + i * hash_size,
+            bench_case->numbers_count,
+            numbers + i * bench_case->numbers_count);
+    }
+
+    /* run, timing every call */
+    state->started = bench_now();
+    for (i = 0; i < state->iterations; ++i) {
+        k = i % BENCH_POOL_SIZE;
+        started = bench_now();
+
+        if (state->operation == OPERATION_ENCODE) {
+            hashids_encode(hashids, hashes + k * hash_size,
+                bench_case->numbers_count,
+                numbers + k * bench_case->numbers_count);
+        } else if (hashids_decode(hashids, hashes + k * hash_size, decoded)
+                != bench_case->numbers_count) {
+            state->error = 1;
+            break;
+        }
+
+        state->latencies[i] = bench_now() - started;
+    }
+    state->finished = bench_now();
+
+cleanup:
+    free(hashes);
+    free(numbers);
+    hashids_free(hashids);
+
+    return NULL;
+}
+
+/* run one case/operation and print a record */
+static int
+bench_run(const struct bench_case_s *bench_case, int operation,
+    size_t iterations, int format, int *first)
+{
+    struct bench_thread_s threads[16];
+    unsigned long long *latencies, started, finished;
+    size_t i, total;
+    double throughput;
+    int error = 0;
+
+    total = iterations * bench_case->threads;
+    latencies = calloc(total, sizeof(unsigned long long));
+    if (!latencies) {
+        fputs("Cannot allocate memory for latencies\n", stderr);
+        return 0;
+    }
+
+    for (i = 0; i < bench_case->threads; ++i) {
+        threads[i].bench_case = bench_case;
+        threads[i].operation = operation;
+        threads[i].iterations = iterations;
+        threads[i].seed = 0x9E3779B97F4A7C15ull * (i + 1);
+        threads[i].latencies = latencies + i * iterations;
+        threads[i].error = 0;
+        if (pthread_create(&threads[i].thread, NULL, bench_thread,
+                &threads[i])) {
+            bench_case = NULL;
+            break;
+        }
+    }
+
+    /* wall time from the first thread starting to the last one finishing */
+    started = ~0ull;
+    finished = 0;
+    while (i-- > 0) {
+        pthread_join(threads[i].thread, NULL);
+        error |= threads[i].error;
+        if (threads[i].started < started) {
+            started = threads[i].started;
+        }
+        if (threads[i].finished > finished) {
+            finished = threads[i].finished;
+        }
+    }
+
+    if (!bench_case || error) {
+        fputs("Benchmark case failed\n", stderr);
+        free(latencies);
+        return 0;
+    }
+
+    qsort(latencies, total, sizeof(unsigned long long), bench_compare);
+    throughput = (double)total * 1e9 / (double)(finished - started);
+
+    if (format == FORMAT_CSV) {
+        printf("%s,%s,%lu,%lu,%lu,%lu,%llu,%lu,%lu,%.0f,%llu,%llu\n",
+            bench_case->dimension, operation_names[operation],
+            bench_case->salt_length, bench_case->alphabet_length,
+            bench_case->min_hash_length, bench_case->numbers_count,
+            bench_case->magnitude, bench_case->threads, total, throughput,
+            latencies[total / 2], latencies[total * 99 / 100]);
+    } else {
+        printf("%s\n  {\"dimension\": \"%s\", \"operation\": \"%s\", "
+            "\"salt_length\": %lu, \"alphabet_length\": %lu, "
+            "\"min_hash_length\": %lu, \"numbers_count\": %lu, "
+            "\"magnitude\": %llu, \"threads\": %lu, \"operations\": %lu, "
+            "\"ops_per_sec\": %.0f, \"p50_ns\": %llu, \"p99_ns\": %llu}",
+            *first ? "[" : ",",
+            bench_case->dimension, operation_names[operation],
+            bench_case->salt_length, bench_case->alphabet_length,
+            bench_case->min_hash_length, bench_case->numbers_count,
+            bench_case->magnitude, bench_case->threads, total, throughput,
+            latencies[total / 2], latencies[total * 99 / 100]);
+    }
+
+    *first = 0;
+    free(latencies);
+    fflush(stdout);
+
+    return 1;
+}
+
+/* run both operations of a case */
+static int
+bench_operations(const struct bench_case_s *bench_case, size_t iterations,
+    int format, int *first)
+{
+    return bench_run(bench_case, OPERATION_ENCODE, iterations, format, first)
+        && bench_run(bench_case, OPERATION_DECODE, iterations, format, first);
+}
+
+/* strtoull()/sprintf() against decimal_parse()/decimal_format() */
+static int
+bench_decimal(size_t iterations, int format)
+{
+    static const char *names[] = {
+        "parse", "strtoull", "parse", "decimal_parse",
+        "format", "sprintf", "format", "decimal_format"
+    };
+    char strings[BENCH_POOL_SIZE][DECIMAL_MAX_LENGTH + 2], buffer[32], *p;
+    const char *q;
+    unsigned long long numbers[BENCH_POOL_SIZE], seed = 42, started,
+        elapsed, sink = 0;
+    size_t i, k, m, lengths[BENCH_POOL_SIZE];
+    int first = 1;
+
+    if (format == FORMAT_CSV) {
+        puts("operation,implementation,magnitude,operations,ns_per_op");
+    }
+
+    for (m = 0; m < lengthof(magnitudes); ++m) {
+        for (i = 0; i < BENCH_POOL_SIZE; ++i) {
+            numbers[i] = bench_random(&seed);
+            if (magnitudes[m] != 18446744073709551615ull) {
+                numbers[i] %= magnitudes[m] + 1;
+            }
+            lengths[i] = sprintf(strings[i], "%llu", numbers[i]);
+        }
+
+        for (k = 0; k < 4; ++k) {
+            started = bench_now();
+
+            for (i = 0; i < iterations; ++i) {
+                switch (k) {
+                    case 0:
+                        sink += strtoull(strings[i % BENCH_POOL_SIZE], &p,
+                            10);
+                        break;
+                    case 1:
+                        sink += decimal_parse(strings[i % BENCH_POOL_SIZE],
+                            strings[i % BENCH_POOL_SIZE]
+                                + lengths[i % BENCH_POOL_SIZE], &q);
+                        break;
+                    case 2:
+                        sink += sprintf(buffer, "%llu",
+                            numbers[i % BENCH_POOL_SIZE]);
+                        break;
+                    default:
+                        sink += decimal_format(buffer,
+                            numbers[i % BENCH_POOL_SIZE]);
+                        break;
+                }
+            }
+
+            elapsed = bench_now() - started;
+
+            if (format == FORMAT_CSV) {
+                printf("%s,%s,%llu,%lu,%.2f\n", names[2 * k],
+                    names[2 * k + 1], magnitudes[m], iterations,
+                    (double)elapsed / iterations);
+            } else {
+                printf("%s\n  {\"operation\": \"%s\", "
+                    "\"implementation\": \"%s\", \"magnitude\": %llu, "
+                    "\"operations\": %lu, \"ns_per_op\": %.2f}",
+                    first ? "[" : ",", names[2 * k], names[2 * k + 1],
+                    magnitudes[m], iterations, (double)elapsed / iterations);
+            }
+
+            first = 0;
+        }
+    }
+
+    if (format == FORMAT_JSON) {
+        puts("\n]");
+    }
+
+    /* keep the results alive */
+    return sink != 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    struct bench_case_s bench_case;
+    size_t i, iterations = 200000;
+    int ch, format = FORMAT_JSON, first = 1, ok = 1, decimal = 0;
+    char *p;
+
+    static const struct option longopts[] = {
+        {"format", required_argument, NULL, 'f'},
+        {"iterations", required_argument, NULL, 'n'},
+        {"decimal", no_argument, NULL, 'd'},
+        {"help", no_argument, NULL, 'h'},
+        {"version", no_argument, NULL, 'v'},
+        {NULL, 0, NULL, 0}
+    };
+
+    /* parse command line options */
+    while ((ch = getopt_long(argc, argv, "f:n:dhv", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'f':
+                if (!strcmp(optarg, "json")) {
+                    format = FORMAT_JSON;
+                } else if (!strcmp(optarg, "csv")) {
+                    format = FORMAT_CSV;
+                } else {
+                    fprintf(stderr, "Invalid format: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'n':
+                iterations = strtoul(optarg, &p, 10);
+                if (p == optarg || !iterations) {
+                    fprintf(stderr, "Invalid iterations: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'd':
+                decimal = 1;
+                break;
+            case 'h':
+                usage(argv[0], stdout);
+                break;
+            case 'v':
+                puts(HASHIDS_VERSION);
+                return EXIT_SUCCESS;
+            default:
+                usage(argv[0], stderr);
+        }
+    }
+
+    if (decimal) {
+        return bench_decimal(iterations * 10, format)
+            ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (format == FORMAT_CSV) {
+        puts("dimension,operation,salt_length,alphabet_length,"
+            "min_hash_length,numbers_count,magnitude,threads,operations,"
+            "ops_per_sec,p50_ns,p99_ns");
+    }
+
+    /* sweep one dimension at a time */
+    ok = ok && bench_operations(&baseline, iterations, format, &first);
+
+    for (i = 0; ok && i < lengthof(magnitudes); ++i) {
+        bench_case = baseline;
+        bench_case.dimension = "magnitude";
+        bench_case.magnitude = magnitudes[i];
+        ok = bench_operations(&bench_case, iterations, format, &first);
+    }
+    for (i = 0; ok && i < lengthof(numbers_counts); ++i) {
+        bench_case = baseline;
+        bench_case.dimension = "numbers_count";
+        bench_case.numbers_count = numbers_counts[i];
+        ok = bench_operations(&bench_case, iterations, format, &first);
+    }
+    for (i = 0; ok && i < lengthof(alphabet_lengths); ++i) {
+        bench_case = baseline;
+        bench_case.dimension = "alphabet_length";
+        bench_case.alphabet_length = alphabet_lengths[i];
+        ok = bench_operations(&bench_case, iterations, format, &first);
+    }
+    for (i = 0; ok && i < lengthof(salt_lengths); ++i) {
+        bench_case = baseline;
+        bench_case.dimension = "salt_length";
+        bench_case.salt_length = salt_lengths[i];
+        ok = bench_operations(&bench_case, iterations, format, &first);
+    }
+    for (i = 0; ok && i < lengthof(min_hash_lengths); ++i) {
+        bench_case = baseline;
+        bench_case.dimension = "min_hash_length";
+        bench_case.min_hash_length = min_hash_lengths[i];
+        ok = bench_operations(&bench_case, iterations, format, &first);
+    }
+    for (i = 0; ok && i < lengthof(threads_counts); ++i) {
+        bench_case = baseline;
+        bench_case.dimension = "threads";
+        bench_case.threads = threads_counts[i];
+        ok = bench_operations(&bench_case, iterations, format, &first);
+    }
+
+    if (format == FORMAT_JSON && !first) {
+        puts("\n]");
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
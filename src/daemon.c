@@ -0,0 +1,1071 @@
+/* accept4() */
+#define _GNU_SOURCE 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "hashids.h"
+#include "hashidsd.h"
+
+/* long-only options */
+enum { OPTION_CACHE = 256 };
+
+/* default encode cache entries, per tenant and worker */
+#define CACHE_SIZE 4096
+
+/* longest cached hash */
+#define CACHE_HASH_LENGTH 23
+
+/* bytes read from a connection per wakeup */
+#define READ_SIZE (64 << 10)
+
+/* pending output above which a connection stops being read */
+#define OUTPUT_MAX (4u << 20)
+
+/* events per epoll_wait() */
+#define EVENTS_COUNT 64
+
+/* a named salt / alphabet / minimum length */
+struct tenant_s {
+    char *name;
+    hashids_t *hashids;
+};
+
+/* a remembered single-number encoding */
+struct cache_entry_s {
+    unsigned long long number;
+    unsigned char length;
+    char hash[CACHE_HASH_LENGTH];
+};
+
+struct buffer_s {
+    unsigned char *data;
+    size_t length;
+    size_t capacity;
+};
+
+struct connection_s {
+    int fd;
+    unsigned int events;
+    int closing;
+    struct buffer_s in;
+    struct buffer_s out;
+    size_t sent;
+    struct connection_s *prev;
+    struct connection_s *next;
+};
+
+struct server_s;
+
+/* a worker owns its connections, its epoll set and its caches */
+struct worker_s {
+    pthread_t thread;
+    int epoll_fd;
+    int wake_fd;
+    struct server_s *server;
+    pthread_mutex_t mutex;
+    struct connection_s *connections;
+    struct cache_entry_s **caches;
+    unsigned long long *numbers;
+    size_t numbers_capacity;
+    char *hash;
+    size_t hash_capacity;
+};
+
+struct server_s {
+    struct tenant_s *tenants;
+    size_t tenants_count;
+    size_t cache_size;
+    struct worker_s *workers;
+    size_t workers_count;
+};
+
+static void
+usage(const char *program_invocation_name, FILE *out)
+{
+    fputs("\n", out);
+    fputs("Usage:\n", out);
+    fprintf(out, "  %s [options] <socket>\n", program_invocation_name);
+
+    fputs("\n", out);
+    fputs("Options:\n", out);
+    fputs("  -c, --config      read tenants from a file, one per line:\n",
+        out);
+    fputs("                    name<TAB>salt<TAB>min-length<TAB>alphabet\n",
+        out);
+    fputs("  -s, --salt        set salt of the \"default\" tenant ["
+        HASHIDS_DEFAULT_SALT "]\n", out);
+    fputs("  -a, --alphabet    set alphabet of the \"default\" tenant\n",
+        out);
+    fprintf(out, "  -l, --min-length  set hash minimum length of the "
+        "\"default\" tenant [%u]\n", HASHIDS_DEFAULT_MIN_HASH_LENGTH);
+    fputs("  -j, --jobs        serve connections on N threads "
+        "(0: one per CPU) [0]\n", out);
+    fprintf(out, "      --cache       encode cache entries per tenant and "
+        "thread (0: off) [%u]\n", CACHE_SIZE);
+    fputs("  -h, --help        display this help and exit\n", out);
+    fputs("  -v, --version     print version information and exit\n", out);
+
+    fputs("\n", out);
+    exit(out == stderr ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+static int
+buffer_reserve(struct buffer_s *buffer, size_t length)
+{
+    size_t capacity;
+    unsigned char *data;
+
+    if (buffer->capacity - buffer->length >= length) {
+        return 1;
+    }
+
+    capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity - buffer->length < length) {
+        capacity *= 2;
+    }
+
+    if (!(data = realloc(buffer->data, capacity))) {
+        return 0;
+    }
+
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+/* add a tenant; reports and fails on invalid settings */
+static int
+tenant_add(struct server_s *server, const char *name, const char *salt,
+    size_t min_hash_length, const char *alphabet)
+{
+    struct tenant_s *tenants, *tenant;
+    size_t i;
+
+    for (i = 0; i < server->tenants_count; ++i) {
+        if (!strcmp(server->tenants[i].name, name)) {
+            fprintf(stderr, "Hashids: Duplicate tenant %s\n", name);
+            return 0;
+        }
+    }
+
+    if (server->tenants_count > 0xFFFF) {
+        fputs("Hashids: Too many tenants\n", stderr);
+        return 0;
+    }
+
+    tenants = realloc(server->tenants,
+        (server->tenants_count + 1) * sizeof(struct tenant_s));
+    if (!tenants) {
+        fputs("Hashids: Allocation failed\n", stderr);
+        return 0;
+    }
+    server->tenants = tenants;
+
+    tenant = &tenants[server->tenants_count];
+    tenant->hashids = hashids_init3(salt, min_hash_length, alphabet);
+
+    if (!tenant->hashids) {
+        switch (hashids_errno) {
+            case HASHIDS_ERROR_ALLOC:
+                fprintf(stderr, "Hashids: %s: Allocation failed\n", name);
+                break;
+            case HASHIDS_ERROR_ALPHABET_LENGTH:
+                fprintf(stderr, "Hashids: %s: Alphabet is too short\n", name);
+                break;
+            case HASHIDS_ERROR_ALPHABET_SPACE:
+                fprintf(stderr, "Hashids: %s: Alphabet contains whitespace "
+                    "characters\n", name);
+                break;
+            default:
+                fprintf(stderr, "Hashids: %s: Unknown error\n", name);
+                break;
+        }
+
+        return 0;
+    }
+
+    if (!(tenant->name = strdup(name))) {
+        hashids_free(tenant->hashids);
+        fputs("Hashids: Allocation failed\n", stderr);
+        return 0;
+    }
+
+    server->tenants_count++;
+    return 1;
+}
+
+/* read tenants from a tab-separated file; `#` starts a comment line */
+static int
+tenants_load(struct server_s *server, const char *path)
+{
+    FILE *file;
+    char *line = NULL, *fields[4], *p;
+    size_t capacity = 0, min_hash_length, count, number = 0;
+    ssize_t length;
+    int ok = 1;
+
+    if (!(file = fopen(path, "r"))) {
+        fprintf(stderr, "Hashids: Cannot open %s: %s\n", path,
+            strerror(errno));
+        return 0;
+    }
+
+    while (ok && (length = getline(&line, &capacity, file)) >= 0) {
+        ++number;
+
+        while (length && (line[length - 1] == '\n'
+                || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+
+        if (!length || line[0] == '#') {
+            continue;
+        }
+
+        /* name, salt, min-length, alphabet */
+        fields[0] = line;
+        fields[1] = HASHIDS_DEFAULT_SALT;
+        fields[2] = NULL;
+        fields[3] = HASHIDS_DEFAULT_ALPHABET;
+        for (count = 1, p = line; count < 4 && (p = strchr(p, '\t'));
+                ++count) {
+            *p++ = '\0';
+            fields[count] = p;
+        }
+
+        min_hash_length = HASHIDS_DEFAULT_MIN_HASH_LENGTH;
+        if (fields[2] && *fields[2]) {
+            min_hash_length = strtoul(fields[2], &p, 10);
+            if (*p) {
+                fprintf(stderr, "Hashids: %s:%lu: Invalid minimum length: "
+                    "%s\n", path, (unsigned long)number, fields[2]);
+                ok = 0;
+                break;
+            }
+        }
+
+        if (!*fields[0]) {
+            fprintf(stderr, "Hashids: %s:%lu: Missing tenant name\n", path,
+                (unsigned long)number);
+            ok = 0;
+            break;
+        }
+
+        ok = tenant_add(server, fields[0], fields[1], min_hash_length,
+            *fields[3] ? fields[3] : HASHIDS_DEFAULT_ALPHABET);
+    }
+
+    if (ok && !server->tenants_count) {
+        fprintf(stderr, "Hashids: %s: No tenants\n", path);
+        ok = 0;
+    }
+
+    free(line);
+    fclose(file);
+    return ok;
+}
+
+/* the hash of numbers[0..count), from the cache where possible */
+static const char *
+worker_encode(struct worker_s *worker, size_t tenant, size_t count,
+    size_t *length)
+{
+    hashids_t *hashids = worker->server->tenants[tenant].hashids;
+    size_t cache_size = worker->server->cache_size, size;
+    struct cache_entry_s *entry = NULL;
+    char *hash;
+
+    if (count == 1 && cache_size) {
+        if (!worker->caches[tenant] && !(worker->caches[tenant] = calloc(
+                cache_size, sizeof(struct cache_entry_s)))) {
+            return NULL;
+        }
+
+        entry = &worker->caches[tenant][(size_t)((worker->numbers[0]
+            * 0x9E3779B97F4A7C15ull) >> 32) % cache_size];
+        if (entry->length && entry->number == worker->numbers[0]) {
+            *length = entry->length;
+            return entry->hash;
+        }
+    }
+
+    size = hashids_estimate_encoded_size(hashids, count, worker->numbers);
+    if (size > worker->hash_capacity) {
+        if (!(hash = realloc(worker->hash, size))) {
+            return NULL;
+        }
+
+        worker->hash = hash;
+        worker->hash_capacity = size;
+    }
+
+    *length = hashids_encode(hashids, worker->hash, count, worker->numbers);
+
+    if (entry && *length && *length <= CACHE_HASH_LENGTH) {
+        entry->number = worker->numbers[0];
+        entry->length = (unsigned char)*length;
+        memcpy(entry->hash, worker->hash, *length);
+    }
+
+    return worker->hash;
+}
+
+static int
+worker_reserve(struct worker_s *worker, size_t count)
+{
+    unsigned long long *numbers;
+
+    if (count <= worker->numbers_capacity) {
+        return 1;
+    }
+
+    if (!(numbers = realloc(worker->numbers,
+            count * sizeof(unsigned long long)))) {
+        return 0;
+    }
+
+    worker->numbers = numbers;
+    worker->numbers_capacity = count;
+    return 1;
+}
+
+/* the body of an ENCODE response; returns a frame status, or -1 when out
+   of memory */
+static int
+handle_encode(struct worker_s *worker, size_t tenant,
+    const unsigned char *p, const unsigned char *end, struct buffer_s *out)
+{
+    unsigned long items, count, i, k;
+    const char *hash;
+    size_t length;
+
+    if (end - p < 4) {
+        return HASHIDSD_STATUS_BAD_REQUEST;
+    }
+
+    items = hashidsd_load_u32(p);
+    p += 4;
+
+    if (!buffer_reserve(out, 4)) {
+        return -1;
+    }
+    hashidsd_store_u32(out->data + out->length, items);
+    out->length += 4;
+
+    for (i = 0; i < items; ++i) {
+        if (end - p < 4) {
+            return HASHIDSD_STATUS_BAD_REQUEST;
+        }
+
+        count = hashidsd_load_u32(p);
+        p += 4;
+
+        if ((size_t)(end - p) / 8 < count) {
+            return HASHIDSD_STATUS_BAD_REQUEST;
+        }
+
+        if (!worker_reserve(worker, count)) {
+            return -1;
+        }
+
+        for (k = 0; k < count; ++k, p += 8) {
+            worker->numbers[k] = hashidsd_load_u64(p);
+        }
+
+        if (!(hash = worker_encode(worker, tenant, count, &length))
+                || !buffer_reserve(out, 4 + length)) {
+            return -1;
+        }
+
+        hashidsd_store_u32(out->data + out->length, length);
+        memcpy(out->data + out->length + 4, hash, length);
+        out->length += 4 + length;
+    }
+
+    return p == end ? HASHIDSD_STATUS_OK : HASHIDSD_STATUS_BAD_REQUEST;
+}
+
+/* the body of a DECODE response */
+static int
+handle_decode(struct worker_s *worker, size_t tenant,
+    const unsigned char *p, const unsigned char *end, struct buffer_s *out)
+{
+    hashids_t *hashids = worker->server->tenants[tenant].hashids;
+    unsigned long items, length, i;
+    size_t count, k;
+    unsigned char *o;
+
+    if (end - p < 4) {
+        return HASHIDSD_STATUS_BAD_REQUEST;
+    }
+
+    items = hashidsd_load_u32(p);
+    p += 4;
+
+    if (!buffer_reserve(out, 4)) {
+        return -1;
+    }
+    hashidsd_store_u32(out->data + out->length, items);
+    out->length += 4;
+
+    for (i = 0; i < items; ++i) {
+        if (end - p < 4) {
+            return HASHIDSD_STATUS_BAD_REQUEST;
+        }
+
+        length = hashidsd_load_u32(p);
+        p += 4;
+
+        if ((size_t)(end - p) < length) {
+            return HASHIDSD_STATUS_BAD_REQUEST;
+        }
+
+        hashids_errno = HASHIDS_ERROR_OK;
+        count = hashids_numbers_count_n(hashids, (const char *)p, length);
+        if (count) {
+            if (!worker_reserve(worker, count)) {
+                return -1;
+            }
+            memset(worker->numbers, 0, count * sizeof(unsigned long long));
+            count = hashids_decode_n(hashids, (const char *)p, length,
+                worker->numbers);
+        }
+        p += length;
+
+        if (!buffer_reserve(out, 8 + 8 * count)) {
+            return -1;
+        }
+
+        o = out->data + out->length;
+        hashidsd_store_u32(o, (unsigned long)(long)hashids_errno);
+        hashidsd_store_u32(o + 4, count);
+        for (k = 0, o += 8; k < count; ++k, o += 8) {
+            hashidsd_store_u64(o, worker->numbers[k]);
+        }
+        out->length += 8 + 8 * count;
+    }
+
+    return p == end ? HASHIDSD_STATUS_OK : HASHIDSD_STATUS_BAD_REQUEST;
+}
+
+/* the body of a LOOKUP response */
+static int
+handle_lookup(struct worker_s *worker, const unsigned char *p,
+    const unsigned char *end, struct buffer_s *out)
+{
+    struct server_s *server = worker->server;
+    size_t i;
+
+    for (i = 0; i < server->tenants_count; ++i) {
+        if (strlen(server->tenants[i].name) == (size_t)(end - p)
+                && !memcmp(server->tenants[i].name, p, end - p)) {
+            if (!buffer_reserve(out, 2)) {
+                return -1;
+            }
+
+            hashidsd_store_u16(out->data + out->length, i);
+            out->length += 2;
+            return HASHIDSD_STATUS_OK;
+        }
+    }
+
+    return HASHIDSD_STATUS_BAD_TENANT;
+}
+
+/* answer one complete request frame */
+static int
+connection_frame(struct worker_s *worker, struct connection_s *conn,
+    const unsigned char *frame, size_t body_length)
+{
+    const unsigned char *body = frame + HASHIDSD_HEADER_SIZE,
+        *end = body + body_length;
+    struct buffer_s *out = &conn->out;
+    size_t tenant = hashidsd_load_u16(frame + 10), start;
+    int status;
+
+    if (!buffer_reserve(out, HASHIDSD_HEADER_SIZE)) {
+        return 0;
+    }
+
+    start = out->length;
+    out->length += HASHIDSD_HEADER_SIZE;
+
+    switch (frame[8]) {
+        case HASHIDSD_OP_ENCODE:
+        case HASHIDSD_OP_DECODE:
+            if (tenant >= worker->server->tenants_count) {
+                status = HASHIDSD_STATUS_BAD_TENANT;
+            } else if (frame[8] == HASHIDSD_OP_ENCODE) {
+                status = handle_encode(worker, tenant, body, end, out);
+            } else {
+                status = handle_decode(worker, tenant, body, end, out);
+            }
+            break;
+        case HASHIDSD_OP_LOOKUP:
+            status = handle_lookup(worker, body, end, out);
+            break;
+        default:
+            status = HASHIDSD_STATUS_BAD_OP;
+            break;
+    }
+
+    if (status < 0) {
+        return 0;
+    }
+
+    /* failed requests have no body */
+    if (status != HASHIDSD_STATUS_OK) {
+        out->length = start + HASHIDSD_HEADER_SIZE;
+    }
+
+    hashidsd_store_u32(out->data + start,
+        out->length - start - HASHIDSD_HEADER_SIZE);
+    memcpy(out->data + start + 4, frame + 4, 4);
+    out->data[start + 8] = frame[8];
+    out->data[start + 9] = 0;
+    hashidsd_store_u16(out->data + start + 10, status);
+
+    return 1;
+}
+
+/* answer the complete frames received so far, as long as the peer keeps
+   up with the responses */
+static int
+connection_process(struct worker_s *worker, struct connection_s *conn)
+{
+    unsigned char *p = conn->in.data;
+    size_t left = conn->in.length;
+    unsigned long body_length;
+
+    while (left >= HASHIDSD_HEADER_SIZE
+            && conn->out.length - conn->sent < OUTPUT_MAX) {
+        body_length = hashidsd_load_u32(p);
+        if (body_length > HASHIDSD_BODY_MAX) {
+            return 0;
+        }
+
+        if (left - HASHIDSD_HEADER_SIZE < body_length) {
+            break;
+        }
+
+        if (!connection_frame(worker, conn, p, body_length)) {
+            return 0;
+        }
+
+        p += HASHIDSD_HEADER_SIZE + body_length;
+        left -= HASHIDSD_HEADER_SIZE + body_length;
+    }
+
+    memmove(conn->in.data, p, left);
+    conn->in.length = left;
+    return 1;
+}
+
+static int
+connection_flush(struct connection_s *conn)
+{
+    ssize_t result;
+
+    while (conn->sent < conn->out.length) {
+        result = send(conn->fd, conn->out.data + conn->sent,
+            conn->out.length - conn->sent, MSG_NOSIGNAL);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+
+            return 0;
+        }
+
+        conn->sent += result;
+    }
+
+    if (conn->sent == conn->out.length) {
+        conn->out.length = conn->sent = 0;
+    }
+
+    return 1;
+}
+
+/* handle readiness; returns 0 when the connection is done */
+static int
+connection_service(struct worker_s *worker, struct connection_s *conn,
+    unsigned int events)
+{
+    struct epoll_event event;
+    unsigned int interest;
+    ssize_t result;
+
+    if (events & EPOLLERR) {
+        return 0;
+    }
+
+    if (events & EPOLLIN) {
+        if (!buffer_reserve(&conn->in, READ_SIZE)) {
+            return 0;
+        }
+
+        result = read(conn->fd, conn->in.data + conn->in.length,
+            conn->in.capacity - conn->in.length);
+
+        if (result > 0) {
+            conn->in.length += result;
+        } else if (!result) {
+            conn->closing = 1;
+        } else if (errno != EINTR && errno != EAGAIN) {
+            return 0;
+        }
+    } else if (events & EPOLLHUP) {
+        return 0;
+    }
+
+    if (!connection_process(worker, conn) || !connection_flush(conn)) {
+        return 0;
+    }
+
+    interest = 0;
+    if (!conn->closing && conn->out.length - conn->sent < OUTPUT_MAX) {
+        interest |= EPOLLIN;
+    }
+    if (conn->sent < conn->out.length) {
+        interest |= EPOLLOUT;
+    }
+
+    if (!interest) {
+        return 0;
+    }
+
+    if (interest != conn->events) {
+        event.events = interest;
+        event.data.ptr = conn;
+        if (epoll_ctl(worker->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event)) {
+            return 0;
+        }
+
+        conn->events = interest;
+    }
+
+    return 1;
+}
+
+static void
+connection_free(struct connection_s *conn)
+{
+    close(conn->fd);
+    free(conn->in.data);
+    free(conn->out.data);
+    free(conn);
+}
+
+static void
+worker_close(struct worker_s *worker, struct connection_s *conn)
+{
+    pthread_mutex_lock(&worker->mutex);
+    if (conn->prev) {
+        conn->prev->next = conn->next;
+    } else {
+        worker->connections = conn->next;
+    }
+    if (conn->next) {
+        conn->next->prev = conn->prev;
+    }
+    pthread_mutex_unlock(&worker->mutex);
+
+    connection_free(conn);
+}
+
+/* hand an accepted socket over to a worker */
+static int
+worker_adopt(struct worker_s *worker, int fd)
+{
+    struct connection_s *conn;
+    struct epoll_event event;
+
+    if (!(conn = calloc(1, sizeof(struct connection_s)))) {
+        close(fd);
+        return 0;
+    }
+
+    conn->fd = fd;
+    conn->events = EPOLLIN;
+
+    pthread_mutex_lock(&worker->mutex);
+    conn->next = worker->connections;
+    if (conn->next) {
+        conn->next->prev = conn;
+    }
+    worker->connections = conn;
+    pthread_mutex_unlock(&worker->mutex);
+
+    event.events = conn->events;
+    event.data.ptr = conn;
+    if (epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, fd, &event)) {
+        worker_close(worker, conn);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void *
+worker_run(void *arg)
+{
+    struct worker_s *worker = arg;
+    struct epoll_event events[EVENTS_COUNT];
+    struct connection_s *conn;
+    int count, i;
+
+    for (;;) {
+        count = epoll_wait(worker->epoll_fd, events, EVENTS_COUNT, -1);
+
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            perror("Hashids: epoll_wait");
+            return NULL;
+        }
+
+        for (i = 0; i < count; ++i) {
+            /* the wake eventfd: shutting down */
+            if (!(conn = events[i].data.ptr)) {
+                return NULL;
+            }
+
+            if (!connection_service(worker, conn, events[i].events)) {
+                worker_close(worker, conn);
+            }
+        }
+    }
+}
+
+static int
+worker_init(struct worker_s *worker, struct server_s *server)
+{
+    struct epoll_event event;
+
+    memset(worker, 0, sizeof(struct worker_s));
+    worker->server = server;
+    worker->epoll_fd = worker->wake_fd = -1;
+    pthread_mutex_init(&worker->mutex, NULL);
+
+    if (!(worker->caches = calloc(server->tenants_count,
+            sizeof(struct cache_entry_s *)))) {
+        return 0;
+    }
+
+    if ((worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0
+            || (worker->wake_fd = eventfd(0, EFD_CLOEXEC)) < 0) {
+        return 0;
+    }
+
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    return !epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->wake_fd,
+        &event);
+}
+
+static void
+worker_destroy(struct worker_s *worker)
+{
+    struct connection_s *conn, *next;
+    size_t i;
+
+    for (conn = worker->connections; conn; conn = next) {
+        next = conn->next;
+        connection_free(conn);
+    }
+
+    if (worker->caches) {
+        for (i = 0; i < worker->server->tenants_count; ++i) {
+            free(worker->caches[i]);
+        }
+        free(worker->caches);
+    }
+
+    if (worker->epoll_fd >= 0) {
+        close(worker->epoll_fd);
+    }
+    if (worker->wake_fd >= 0) {
+        close(worker->wake_fd);
+    }
+
+    pthread_mutex_destroy(&worker->mutex);
+    free(worker->numbers);
+    free(worker->hash);
+}
+
+/* a listening socket at `path`, replacing a stale socket */
+static int
+listen_unix(const char *path)
+{
+    struct sockaddr_un address;
+    struct stat st;
+    int fd;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Hashids: Socket path too long: %s\n", path);
+        return -1;
+    }
+
+    if (!lstat(path, &st)) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "Hashids: %s exists and is not a socket\n", path);
+            return -1;
+        }
+
+        unlink(path);
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+            0)) < 0
+            || bind(fd, (struct sockaddr *)&address, sizeof(address))
+            || listen(fd, SOMAXCONN)) {
+        fprintf(stderr, "Hashids: Cannot listen on %s: %s\n", path,
+            strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+
+    return fd;
+}
+
+/* accept connections until SIGINT / SIGTERM */
+static int
+serve(struct server_s *server, int listen_fd, int signal_fd)
+{
+    struct epoll_event event, events[2];
+    size_t next = 0;
+    int epoll_fd, count, i, fd;
+
+    if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        perror("Hashids: epoll_create1");
+        return 0;
+    }
+
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+    event.data.fd = signal_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &event);
+
+    for (;;) {
+        count = epoll_wait(epoll_fd, events, 2, -1);
+
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            perror("Hashids: epoll_wait");
+            close(epoll_fd);
+            return 0;
+        }
+
+        for (i = 0; i < count; ++i) {
+            if (events[i].data.fd == signal_fd) {
+                close(epoll_fd);
+                return 1;
+            }
+
+            /* round-robin over the workers */
+            while ((fd = accept4(listen_fd, NULL, NULL,
+                    SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                worker_adopt(&server->workers[next++ % server->workers_count],
+                    fd);
+            }
+        }
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    struct server_s server;
+    char *salt = HASHIDS_DEFAULT_SALT, *alphabet = HASHIDS_DEFAULT_ALPHABET,
+        *config = NULL, *p;
+    size_t min_hash_length = HASHIDS_DEFAULT_MIN_HASH_LENGTH, jobs = 0,
+        started = 0, i;
+    unsigned int inline_tenant = 0;
+    unsigned long long one = 1;
+    int ch, listen_fd, signal_fd, ok = 0;
+    sigset_t signals;
+
+    static const struct option longopts[] = {
+        {"config", required_argument, NULL, 'c'},
+        {"salt", required_argument, NULL, 's'},
+        {"alphabet", required_argument, NULL, 'a'},
+        {"min-length", required_argument, NULL, 'l'},
+        {"jobs", required_argument, NULL, 'j'},
+        {"cache", required_argument, NULL, OPTION_CACHE},
+        {"help", no_argument, NULL, 'h'},
+        {"version", no_argument, NULL, 'v'},
+        {NULL, 0, NULL, 0}
+    };
+
+    memset(&server, 0, sizeof(server));
+    server.cache_size = CACHE_SIZE;
+
+    /* parse command line options */
+    while ((ch = getopt_long(argc, argv, "c:s:a:l:j:hv", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'c':
+                config = optarg;
+                break;
+            case 's':
+                salt = optarg;
+                inline_tenant = 1;
+                break;
+            case 'a':
+                alphabet = optarg;
+                inline_tenant = 1;
+                break;
+            case 'l':
+                min_hash_length = strtoul(optarg, &p, 10);
+                if (p == optarg || *p) {
+                    fprintf(stderr, "Invalid minimum length: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                inline_tenant = 1;
+                break;
+            case 'j':
+                jobs = strtoul(optarg, &p, 10);
+                if (p == optarg || *p) {
+                    fprintf(stderr, "Invalid number of jobs: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_CACHE:
+                server.cache_size = strtoul(optarg, &p, 10);
+                if (p == optarg || *p) {
+                    fprintf(stderr, "Invalid cache size: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'h':
+                usage(argv[0], stdout);
+                break;
+            case 'v':
+                puts(HASHIDS_VERSION);
+                return EXIT_SUCCESS;
+            default:
+                usage(argv[0], stderr);
+        }
+    }
+
+    if (optind + 1 != argc) {
+        usage(argv[0], stderr);
+    }
+
+    if (config && inline_tenant) {
+        fputs("Hashids: --config replaces --salt, --alphabet and "
+            "--min-length\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    if (!jobs) {
+        jobs = sysconf(_SC_NPROCESSORS_ONLN) > 0
+            ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    }
+
+    /* tenants */
+    if (config ? !tenants_load(&server, config)
+            : !tenant_add(&server, "default", salt, min_hash_length,
+                alphabet)) {
+        goto done;
+    }
+
+    /* signals are read from a signalfd; workers inherit the mask */
+    signal(SIGPIPE, SIG_IGN);
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    if ((signal_fd = signalfd(-1, &signals, SFD_CLOEXEC)) < 0) {
+        perror("Hashids: signalfd");
+        goto done;
+    }
+
+    if ((listen_fd = listen_unix(argv[optind])) < 0) {
+        close(signal_fd);
+        goto done;
+    }
+
+    /* workers */
+    if (!(server.workers = calloc(jobs, sizeof(struct worker_s)))) {
+        fputs("Hashids: Allocation failed\n", stderr);
+        goto close;
+    }
+
+    for (server.workers_count = 0; server.workers_count < jobs;
+            ++server.workers_count) {
+        if (!worker_init(&server.workers[server.workers_count], &server)) {
+            perror("Hashids: Cannot start worker");
+            worker_destroy(&server.workers[server.workers_count]);
+            goto stop;
+        }
+    }
+
+    for (started = 0; started < jobs; ++started) {
+        if (pthread_create(&server.workers[started].thread, NULL, worker_run,
+                &server.workers[started])) {
+            fputs("Hashids: Cannot start worker\n", stderr);
+            goto stop;
+        }
+    }
+
+    ok = serve(&server, listen_fd, signal_fd);
+
+stop:
+    for (i = 0; i < started; ++i) {
+        if (write(server.workers[i].wake_fd, &one, sizeof(one)) < 0) {
+            perror("Hashids: Cannot stop worker");
+        }
+    }
+    for (i = 0; i < started; ++i) {
+        pthread_join(server.workers[i].thread, NULL);
+    }
+    for (i = 0; i < server.workers_count; ++i) {
+        worker_destroy(&server.workers[i]);
+    }
+    free(server.workers);
+
+close:
+    close(listen_fd);
+    close(signal_fd);
+    unlink(argv[optind]);
+
+done:
+    for (i = 0; i < server.tenants_count; ++i) {
+        free(server.tenants[i].name);
+        hashids_free(server.tenants[i].hashids);
+    }
+    free(server.tenants);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,127 @@
+#ifndef HASHIDS_DECIMAL_H
+#define HASHIDS_DECIMAL_H 1
+
+/* strict base-10 parsing and formatting for the CLI bulk paths */
+
+#include <stddef.h>
+#include <string.h>
+
+/* longest formatted unsigned long long */
+#define DECIMAL_MAX_LENGTH 20
+
+/* "00" to "99" */
+static const char decimal_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+static const unsigned long long decimal_powers[DECIMAL_MAX_LENGTH] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+    10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+    100000000000ull, 1000000000000ull, 10000000000000ull,
+    100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+    100000000000000000ull, 1000000000000000000ull,
+    10000000000000000000ull
+};
+
+/* eight characters, the first one in the lowest byte */
+static inline unsigned long long
+decimal_load8(const char *s)
+{
+    unsigned long long v;
+
+    memcpy(&v, s, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+
+    return v;
+}
+
+/* are all eight characters digits? */
+static inline int
+decimal_digits8(unsigned long long v)
+{
+    return ((v & 0xF0F0F0F0F0F0F0F0ull)
+        | (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4))
+        == 0x3333333333333333ull;
+}
+
+/* the value of eight digits (three multiplications) */
+static inline unsigned long long
+decimal_value8(unsigned long long v)
+{
+    v -= 0x3030303030303030ull;
+    v = v * 10 + (v >> 8);
+
+    return ((v & 0x000000FF000000FFull) * (100 + (1000000ull << 32))
+        + ((v >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))
+        >> 32;
+}
+
+/* parse the digits at the start of s[0..end); *p is left at the first
+   non-digit, or at s if there are none or the number overflows */
+static unsigned long long
+decimal_parse(const char *s, const char *end, const char **p)
+{
+    unsigned long long number = 0, chunk;
+    unsigned int digit;
+    const char *start = s;
+
+    /* eight digits at a time */
+    while (end - s >= 8 && decimal_digits8(chunk = decimal_load8(s))) {
+        chunk = decimal_value8(chunk);
+        if (number >= 184467440737ull
+                && number > (~0ull - chunk) / 100000000ull) {
+            *p = start;
+            return 0;
+        }
+
+        number = number * 100000000ull + chunk;
+        s += 8;
+    }
+
+    for (; s < end && (digit = (unsigned char)*s - '0') < 10; ++s) {
+        if (number >= 1844674407370955161ull
+                && (number > 1844674407370955161ull || digit > 5)) {
+            *p = start;
+            return 0;
+        }
+
+        number = number * 10 + digit;
+    }
+
+    *p = s;
+    return number;
+}
+
+/* write the digits of number to buffer (DECIMAL_MAX_LENGTH bytes, not
+   terminated); returns their count */
+static size_t
+decimal_format(char *buffer, unsigned long long number)
+{
+    size_t length = 1;
+    char *p;
+
+    while (length < DECIMAL_MAX_LENGTH && number >= decimal_powers[length]) {
+        ++length;
+    }
+
+    /* two digits at a time, from the end */
+    p = buffer + length;
+    while (number >= 100) {
+        p -= 2;
+        memcpy(p, decimal_pairs + number % 100 * 2, 2);
+        number /= 100;
+    }
+
+    if (number >= 10) {
+        memcpy(p - 2, decimal_pairs + number * 2, 2);
+    } else {
+        p[-1] = (char)('0' + number);
+    }
+
+    return length;
+}
+
+#endif
@@ -0,0 +1,711 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <getopt.h>
+
+#include "hashids.h"
+
+/* the generated code; "@" stands for the function prefix */
+static const char *source_functions =
+    "/* consistent shuffle, salted with ALPHABET_LENGTH characters */\n"
+    "static void\n"
+    "shuffle(char *str, const char *salt)\n"
+    "{\n"
+    "    size_t i, j, v, p;\n"
+    "    char temp;\n"
+    "\n"
+    "    for (i = ALPHABET_LENGTH - 1, v = 0, p = 0; i > 0; --i, ++v) {\n"
+    "        p += salt[v];\n"
+    "        j = (salt[v] + v + p) % i;\n"
+    "\n"
+    "        temp = str[i];\n"
+    "        str[i] = str[j];\n"
+    "        str[j] = temp;\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "/* \"lottery + salt\"; the rest is filled in by salt_shuffle() */\n"
+    "static void\n"
+    "salt_init(char *iteration_salt, char lottery)\n"
+    "{\n"
+    "    iteration_salt[0] = lottery;\n"
+    "    memcpy(iteration_salt + 1, salt, SALT_LENGTH);\n"
+    "}\n"
+    "\n"
+    "/* re-salt and shuffle the working alphabet before each number */\n"
+    "static void\n"
+    "salt_shuffle(char *working, char *iteration_salt)\n"
+    "{\n"
+    "#if P_MAX > 0\n"
+    "    memcpy(iteration_salt + SALT_LENGTH + 1, working, P_MAX);\n"
+    "#endif\n"
+    "    shuffle(working, iteration_salt);\n"
+    "}\n"
+    "\n"
+    "/* digit values of a working alphabet, by code */\n"
+    "static const unsigned char *\n"
+    "invert(unsigned char *inverse, const char *working)\n"
+    "{\n"
+    "    size_t i;\n"
+    "\n"
+    "    for (i = 0; i < ALPHABET_LENGTH; ++i) {\n"
+    "        inverse[codes[(unsigned char)working[i]]] = (unsigned char)i;\n"
+    "    }\n"
+    "\n"
+    "    return inverse;\n"
+    "}\n"
+    "\n"
+    "static size_t\n"
+    "digits(unsigned long long number)\n"
+    "{\n"
+    "    size_t n = 1;\n"
+    "\n"
+    "    while (number >= ALPHABET_LENGTH) {\n"
+    "        number /= ALPHABET_LENGTH;\n"
+    "        ++n;\n"
+    "    }\n"
+    "\n"
+    "    return n;\n"
+    "}\n"
+    "\n"
+    "#if MIN_HASH_LENGTH > 0\n"
+    "/* add guards and padding up to MIN_HASH_LENGTH */\n"
+    "static size_t\n"
+    "pad(char *buffer, size_t length, unsigned long long numbers_hash,\n"
+    "    char *working, char *scratch)\n"
+    "{\n"
+    "    size_t left, right;\n"
+    "\n"
+    "    if (length >= MIN_HASH_LENGTH) {\n"
+    "        return length;\n"
+    "    }\n"
+    "\n"
+    "    /* add a guard before the encoded numbers */\n"
+    "    memmove(buffer + 1, buffer, length);\n"
+    "    buffer[0] = guards[(numbers_hash + buffer[1]) % GUARDS_COUNT];\n"
+    "    if (++length >= MIN_HASH_LENGTH) {\n"
+    "        return length;\n"
+    "    }\n"
+    "\n"
+    "    /* add a guard after the encoded numbers */\n"
+    "    buffer[length] = guards[(numbers_hash + buffer[2]) % GUARDS_COUNT];\n"
+    "    ++length;\n"
+    "\n"
+    "    /* pad with half alphabet before and after */\n"
+    "    while (length < MIN_HASH_LENGTH) {\n"
+    "        memcpy(scratch, working, ALPHABET_LENGTH);\n"
+    "        shuffle(working, scratch);\n"
+    "\n"
+    "        left = (MIN_HASH_LENGTH - length + 1) / 2;\n"
+    "        right = (MIN_HASH_LENGTH - length) / 2;\n"
+    "        if (left > (ALPHABET_LENGTH + 1) / 2) {\n"
+    "            left = (ALPHABET_LENGTH + 1) / 2;\n"
+    "        }\n"
+    "        if (right > ALPHABET_LENGTH / 2) {\n"
+    "            right = ALPHABET_LENGTH / 2;\n"
+    "        }\n"
+    "        if ((left + right) % 2 == 0 && ALPHABET_LENGTH % 2 == 1) {\n"
+    "            ++left;\n"
+    "            --right;\n"
+    "        }\n"
+    "\n"
+    "        memmove(buffer + left, buffer, length);\n"
+    "        memcpy(buffer, working + ALPHABET_LENGTH - left, left);\n"
+    "        memcpy(buffer + left + length, working, right);\n"
+    "        length += left + right;\n"
+    "    }\n"
+    "\n"
+    "    return length;\n"
+    "}\n"
+    "#endif\n"
+    "\n"
+    "/* skip the padding up to (and including) the first guard */\n"
+    "static const char *\n"
+    "skip_guard(const char *str, const char *end)\n"
+    "{\n"
+    "#if MIN_HASH_LENGTH > 0\n"
+    "    const char *p;\n"
+    "\n"
+    "    for (p = str; p < end; ++p) {\n"
+    "        if (classes[(unsigned char)*p] == CLASS_GUARD) {\n"
+    "            return p + 1;\n"
+    "        }\n"
+    "    }\n"
+    "#endif\n"
+    "\n"
+    "    (void)end;\n"
+    "    return str;\n"
+    "}\n"
+    "\n"
+    "size_t\n"
+    "@_encoded_size(size_t numbers_count, const unsigned long long *numbers)\n"
+    "{\n"
+    "    size_t i, length = numbers_count;\n"
+    "\n"
+    "    if (!numbers_count) {\n"
+    "        return 0;\n"
+    "    }\n"
+    "\n"
+    "    /* lottery + digits + separators, padded to MIN_HASH_LENGTH */\n"
+    "    for (i = 0; i < numbers_count; ++i) {\n"
+    "        length += digits(numbers[i]);\n"
+    "    }\n"
+    "\n"
+    "    return length > MIN_HASH_LENGTH ? length : MIN_HASH_LENGTH;\n"
+    "}\n"
+    "\n"
+    "size_t\n"
+    "@_encode(char *buffer, size_t numbers_count,\n"
+    "    const unsigned long long *numbers)\n"
+    "{\n"
+    "    char working[ALPHABET_LENGTH], iteration_salt[ALPHABET_LENGTH];\n"
+    "    unsigned long long number, numbers_hash;\n"
+    "    size_t i, j, n, lottery, length;\n"
+    "\n"
+    "    if (!numbers_count) {\n"
+    "        buffer[0] = '\\0';\n"
+    "        return 0;\n"
+    "    }\n"
+    "\n"
+    "    for (i = 0, numbers_hash = 0; i < numbers_count; ++i) {\n"
+    "        numbers_hash += numbers[i] % (i + 100);\n"
+    "    }\n"
+    "\n"
+    "    /* lottery character */\n"
+    "    lottery = numbers_hash % ALPHABET_LENGTH;\n"
+    "    buffer[0] = alphabet[lottery];\n"
+    "    length = 1;\n"
+    "\n"
+    "    /* the first shuffle is precomputed */\n"
+    "    memcpy(working, lottery_alphabets[lottery], ALPHABET_LENGTH);\n"
+    "    if (numbers_count > 1) {\n"
+    "        salt_init(iteration_salt, buffer[0]);\n"
+    "    }\n"
+    "\n"
+    "    for (i = 0; i < numbers_count; ++i) {\n"
+    "        if (i) {\n"
+    "            salt_shuffle(working, iteration_salt);\n"
+    "        }\n"
+    "\n"
+    "        /* the digits, most significant first */\n"
+    "        number = numbers[i];\n"
+    "        n = digits(number);\n"
+    "        for (j = n; j > 0; --j) {\n"
+    "            buffer[length + j - 1] = working[number % ALPHABET_LENGTH];\n"
+    "            number /= ALPHABET_LENGTH;\n"
+    "        }\n"
+    "\n"
+    "        if (i + 1 < numbers_count) {\n"
+    "            number = numbers[i] % (buffer[length] + i);\n"
+    "            buffer[length + n++] = separators[number % SEPARATORS_COUNT];\n"
+    "        }\n"
+    "\n"
+    "        length += n;\n"
+    "    }\n"
+    "\n"
+    "#if MIN_HASH_LENGTH > 0\n"
+    "    length = pad(buffer, length, numbers_hash, working, iteration_salt);\n"
+    "#endif\n"
+    "\n"
+    "    buffer[length] = '\\0';\n"
+    "    return length;\n"
+    "}\n"
+    "\n"
+    "size_t\n"
+    "@_numbers_count(const char *str, size_t length)\n"
+    "{\n"
+    "    const char *end = str + length;\n"
+    "    size_t numbers_count = 1;\n"
+    "\n"
+    "    /* an empty hash (the encoding of no numbers) */\n"
+    "    str = skip_guard(str, end);\n"
+    "    if (str == end || !*str) {\n"
+    "        return 0;\n"
+    "    }\n"
+    "\n"
+    "    for (; str < end; ++str) {\n"
+    "        switch (classes[(unsigned char)*str]) {\n"
+    "            case CLASS_GUARD:\n"
+    "                return numbers_count;\n"
+    "            case CLASS_SEPARATOR:\n"
+    "                ++numbers_count;\n"
+    "                break;\n"
+    "            case CLASS_INVALID:\n"
+    "                return 0;\n"
+    "        }\n"
+    "    }\n"
+    "\n"
+    "    return numbers_count;\n"
+    "}\n"
+    "\n"
+    "size_t\n"
+    "@_decode(const char *str, size_t length, unsigned long long *numbers)\n"
+    "{\n"
+    "    char working[ALPHABET_LENGTH], iteration_salt[ALPHABET_LENGTH];\n"
+    "    unsigned char inverse[ALPHABET_LENGTH], c;\n"
+    "    const unsigned char *digit;\n"
+    "    const char *end = str + length;\n"
+    "    unsigned long long number;\n"
+    "    size_t numbers_count, n;\n"
+    "\n"
+    "    numbers_count = @_numbers_count(str, length);\n"
+    "    if (!numbers || !numbers_count) {\n"
+    "        return numbers_count;\n"
+    "    }\n"
+    "\n"
+    "    /* an empty hash (the encoding of no numbers) */\n"
+    "    str = skip_guard(str, end);\n"
+    "    if (str == end || !*str) {\n"
+    "        return 0;\n"
+    "    }\n"
+    "\n"
+    "    /* the first shuffle is precomputed for alphabet lotteries */\n"
+    "    salt_init(iteration_salt, *str);\n"
+    "    if (classes[(unsigned char)*str] == CLASS_ALPHABET) {\n"
+    "        c = codes[(unsigned char)*str];\n"
+    "        memcpy(working, lottery_alphabets[c], ALPHABET_LENGTH);\n"
+    "        digit = lottery_digits[c];\n"
+    "    } else {\n"
+    "        memcpy(working, alphabet, ALPHABET_LENGTH);\n"
+    "        salt_shuffle(working, iteration_salt);\n"
+    "        digit = invert(inverse, working);\n"
+    "    }\n"
+    "\n"
+    "    for (++str, number = 0, n = 0; str < end; ++str) {\n"
+    "        c = classes[(unsigned char)*str];\n"
+    "\n"
+    "        if (c == CLASS_GUARD) {\n"
+    "            break;\n"
+    "        }\n"
+    "        if (c == CLASS_SEPARATOR) {\n"
+    "            /* as in hashids_decode_n(), not past the count */\n"
+    "            if (n < numbers_count) {\n"
+    "                numbers[n] = number;\n"
+    "            }\n"
+    "\n"
+    "            ++n;\n"
+    "            number = 0;\n"
+    "\n"
+    "            /* resalt the alphabet */\n"
+    "            salt_shuffle(working, iteration_salt);\n"
+    "            digit = invert(inverse, working);\n"
+    "            continue;\n"
+    "        }\n"
+    "        if (c != CLASS_ALPHABET) {\n"
+    "            return 0;\n"
+    "        }\n"
+    "\n"
+    "        number = number * ALPHABET_LENGTH\n"
+    "            + digit[codes[(unsigned char)*str]];\n"
+    "    }\n"
+    "\n"
+    "    if (n < numbers_count) {\n"
+    "        numbers[n] = number;\n"
+    "    }\n"
+    "\n"
+    "    return numbers_count;\n"
+    "}\n";
+
+static void
+usage(const char *program_invocation_name, FILE *out)
+{
+    fputs("\n", out);
+    fputs("Usage:\n", out);
+    fprintf(out, "  %s [options] <output>\n", program_invocation_name);
+
+    fputs("\n", out);
+    fputs("Writes <output>.c and <output>.h: hashids encode/decode functions\n"
+        "specialized for one salt, alphabet and minimum length.\n", out);
+
+    fputs("\n", out);
+    fputs("Options:\n", out);
+    fputs("  -s, --salt        set salt [" HASHIDS_DEFAULT_SALT "]\n", out);
+    fputs("  -a, --alphabet    set alphabet [" HASHIDS_DEFAULT_ALPHABET "]\n",
+        out);
+    fprintf(out, "  -l, --min-length  set hash minimum length [%u]\n",
+        HASHIDS_DEFAULT_MIN_HASH_LENGTH);
+    fputs("  -p, --prefix      function prefix [basename of output]\n", out);
+    fputs("  -h, --help        display this help and exit\n", out);
+    fputs("  -v, --version     print version information and exit\n", out);
+
+    fputs("\n", out);
+    exit(out == stderr ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/* print str[0..length) as a C string literal */
+static void
+emit_string(FILE *out, const char *str, size_t length)
+{
+    unsigned char ch;
+    size_t i;
+    int octal = 0;
+
+    fputc('"', out);
+    for (i = 0; i < length; ++i) {
+        ch = (unsigned char)str[i];
+
+        if (ch == '"' || ch == '\\') {
+            fprintf(out, "\\%c", ch);
+        } else if (ch == '?') {
+            /* no trigraphs */
+            fputs("\\?", out);
+        } else if (isprint(ch) && !(octal && isdigit(ch))) {
+            fputc(ch, out);
+        } else {
+            fprintf(out, "\\%03o", ch);
+            octal = 1;
+            continue;
+        }
+
+        octal = 0;
+    }
+    fputc('"', out);
+}
+
+/* print a 256-entry table */
+static void
+emit_table(FILE *out, const char *name, const unsigned char *table)
+{
+    size_t i;
+
+    fprintf(out, "static const unsigned char %s[256] = {", name);
+    for (i = 0; i < 256; ++i) {
+        fprintf(out, "%s%3u,", i % 16 ? " " : "\n    ", table[i]);
+    }
+    fputs("\n};\n\n", out);
+}
+
+/* copy the generated code, replacing "@" with prefix */
+static void
+emit_code(FILE *out, const char *code, const char *prefix)
+{
+    for (; *code; ++code) {
+        if (*code == '@') {
+            fputs(prefix, out);
+        } else {
+            fputc(*code, out);
+        }
+    }
+}
+
+/* the working alphabet after the first shuffle for the lottery at
+   alphabet[lottery] (hashids_salt_init() and hashids_salt_shuffle()) */
+static void
+first_shuffle(hashids_t *hashids, size_t lottery, size_t salt_length,
+    char *working)
+{
+    size_t alphabet_length = hashids->alphabet_length;
+    long p_max = (long)alphabet_length - 1 - (long)hashids->salt_length;
+    char iteration_salt[256];
+
+    memcpy(working, hashids->alphabet, alphabet_length);
+    iteration_salt[0] = hashids->alphabet[lottery];
+    memcpy(iteration_salt + 1, hashids->salt, salt_length);
+    if (p_max > 0) {
+        memcpy(iteration_salt + salt_length + 1, working, p_max);
+    }
+
+    hashids_shuffle(working, alphabet_length, iteration_salt,
+        alphabet_length);
+}
+
+static int
+write_header(const char *path, const char *guard, const char *prefix,
+    const char *upper, hashids_t *hashids, size_t max_digits)
+{
+    FILE *out;
+
+    if (!(out = fopen(path, "w"))) {
+        return 0;
+    }
+
+    fputs("/* generated by hashids-gen; do not edit */\n\n", out);
+    fprintf(out, "#ifndef %s\n#define %s 1\n\n", guard, guard);
+    fputs("#include <stddef.h>\n\n", out);
+    fprintf(out, "/* digits of the largest number */\n"
+        "#define %s_MAX_DIGITS %lu\n\n", upper, (unsigned long)max_digits);
+    fprintf(out, "/* longest hash of count numbers (without the NUL) */\n"
+        "#define %s_MAX_LENGTH(count) \\\n"
+        "    ((count) * %luu > %luu ? (count) * %luu : %luu)\n\n", upper,
+        (unsigned long)max_digits + 1,
+        (unsigned long)hashids->min_hash_length,
+        (unsigned long)max_digits + 1,
+        (unsigned long)hashids->min_hash_length);
+    fputs("#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n", out);
+    fprintf(out, "/* exact length of the hash of numbers[0..numbers_count) */\n"
+        "size_t\n%s_encoded_size(size_t numbers_count,\n"
+        "    const unsigned long long *numbers);\n\n", prefix);
+    fprintf(out, "/* encode numbers[0..numbers_count) to buffer (encoded size "
+        "+ 1 bytes) */\n"
+        "size_t\n%s_encode(char *buffer, size_t numbers_count,\n"
+        "    const unsigned long long *numbers);\n\n", prefix);
+    fprintf(out, "/* numbers in str[0..length); 0 for invalid hashes */\n"
+        "size_t\n%s_numbers_count(const char *str, size_t length);\n\n",
+        prefix);
+    fprintf(out, "/* decode str[0..length) to numbers (numbers_count slots); "
+        "0 for invalid\n   hashes */\n"
+        "size_t\n%s_decode(const char *str, size_t length, "
+        "unsigned long long *numbers);\n\n", prefix);
+    fputs("#ifdef __cplusplus\n}\n#endif\n\n#endif\n", out);
+
+    return !fclose(out);
+}
+
+static int
+write_source(const char *path, const char *header, const char *prefix,
+    hashids_t *hashids)
+{
+    size_t i, j, alphabet_length = hashids->alphabet_length,
+        salt_length = hashids->salt_length;
+    unsigned char classes[256], codes[256], inverse[256];
+    long p_max = (long)alphabet_length - 1 - (long)salt_length;
+    char working[256];
+    FILE *out;
+
+    if (!(out = fopen(path, "w"))) {
+        return 0;
+    }
+
+    if (salt_length > alphabet_length - 1) {
+        salt_length = alphabet_length - 1;
+    }
+
+    /* character classes and alphabet positions */
+    memset(classes, 0, sizeof(classes));
+    memset(codes, 0, sizeof(codes));
+    for (i = 0; i < alphabet_length; ++i) {
+        classes[(unsigned char)hashids->alphabet[i]] = 1;
+        codes[(unsigned char)hashids->alphabet[i]] = (unsigned char)i;
+    }
+    for (i = 0; i < hashids->separators_count; ++i) {
+        classes[(unsigned char)hashids->separators[i]] = 2;
+    }
+    for (i = 0; i < hashids->guards_count; ++i) {
+        classes[(unsigned char)hashids->guards[i]] = 3;
+    }
+    classes[0] = 3;
+
+    fputs("/* generated by hashids-gen; do not edit */\n\n", out);
+    fputs("#include <string.h>\n\n", out);
+    fprintf(out, "#include \"%s\"\n\n", header);
+
+    fprintf(out, "#define ALPHABET_LENGTH %lu\n",
+        (unsigned long)alphabet_length);
+    fprintf(out, "#define SEPARATORS_COUNT %lu\n",
+        (unsigned long)hashids->separators_count);
+    fprintf(out, "#define GUARDS_COUNT %lu\n",
+        (unsigned long)hashids->guards_count);
+    fprintf(out, "#define SALT_LENGTH %lu\n", (unsigned long)salt_length);
+    fprintf(out, "#define P_MAX %ld\n", p_max > 0 ? p_max : 0);
+    fprintf(out, "#define MIN_HASH_LENGTH %luu\n\n",
+        (unsigned long)hashids->min_hash_length);
+
+    fputs("enum { CLASS_INVALID, CLASS_ALPHABET, CLASS_SEPARATOR, "
+        "CLASS_GUARD };\n\n", out);
+
+    fputs("/* what hashids_init3() derives */\nstatic const char alphabet[] = ",
+        out);
+    emit_string(out, hashids->alphabet, alphabet_length);
+    fputs(";\nstatic const char separators[] = ", out);
+    emit_string(out, hashids->separators, hashids->separators_count);
+    fputs(";\n", out);
+    if (hashids->min_hash_length) {
+        fputs("static const char guards[] = ", out);
+        emit_string(out, hashids->guards, hashids->guards_count);
+        fputs(";\n", out);
+    }
+    fputs("\n/* the part of the salt used in iteration salts */\n"
+        "static const char salt[] = ", out);
+    emit_string(out, hashids->salt, salt_length);
+    fputs(";\n\n", out);
+
+    fputs("/* character classes */\n", out);
+    emit_table(out, "classes", classes);
+    fputs("/* positions in alphabet */\n", out);
+    emit_table(out, "codes", codes);
+
+    /* the first shuffle of each lottery */
+    fputs("/* the working alphabet after the first shuffle, by lottery "
+        "code */\n"
+        "static const char lottery_alphabets[ALPHABET_LENGTH]"
+        "[ALPHABET_LENGTH] = {\n", out);
+    for (i = 0; i < alphabet_length; ++i) {
+        first_shuffle(hashids, i, salt_length, working);
+
+        fputs("    ", out);
+        emit_string(out, working, alphabet_length);
+        fputs(",\n", out);
+    }
+    fputs("};\n\n", out);
+
+    fputs("/* digit values after the first shuffle, by lottery code and "
+        "code */\n"
+        "static const unsigned char lottery_digits[ALPHABET_LENGTH]"
+        "[ALPHABET_LENGTH] = {\n", out);
+    for (i = 0; i < alphabet_length; ++i) {
+        first_shuffle(hashids, i, salt_length, working);
+        for (j = 0; j < alphabet_length; ++j) {
+            inverse[codes[(unsigned char)working[j]]] = (unsigned char)j;
+        }
+
+        fputs("    {", out);
+        for (j = 0; j < alphabet_length; ++j) {
+            fprintf(out, "%s%u", j ? (j % 16 ? ", " : ",\n     ") : "",
+                inverse[j]);
+        }
+        fputs("},\n", out);
+    }
+    fputs("};\n\n", out);
+
+    emit_code(out, source_functions, prefix);
+
+    return !fclose(out);
+}
+
+int
+main(int argc, char **argv)
+{
+    hashids_t *hashids;
+    const char *salt = HASHIDS_DEFAULT_SALT,
+        *alphabet = HASHIDS_DEFAULT_ALPHABET, *prefix = NULL, *output,
+        *header;
+    size_t min_hash_length = HASHIDS_DEFAULT_MIN_HASH_LENGTH, i, length,
+        max_digits;
+    unsigned long long number;
+    char *p, *path, *guard, *upper;
+    int ch, ok;
+
+    static const struct option longopts[] = {
+        {"salt", required_argument, NULL, 's'},
+        {"alphabet", required_argument, NULL, 'a'},
+        {"min-length", required_argument, NULL, 'l'},
+        {"prefix", required_argument, NULL, 'p'},
+        {"help", no_argument, NULL, 'h'},
+        {"version", no_argument, NULL, 'v'},
+        {NULL, 0, NULL, 0}
+    };
+
+    /* parse command line options */
+    while ((ch = getopt_long(argc, argv, "s:a:l:p:hv", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 's':
+                salt = optarg;
+                break;
+            case 'a':
+                alphabet = optarg;
+                break;
+            case 'l':
+                min_hash_length = strtoul(optarg, &p, 10);
+                if (p == optarg) {
+                    fprintf(stderr, "Invalid minimum length: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'p':
+                prefix = optarg;
+                break;
+            case 'h':
+                usage(argv[0], stdout);
+                break;
+            case 'v':
+                puts(HASHIDS_VERSION);
+                return EXIT_SUCCESS;
+            default:
+                usage(argv[0], stderr);
+        }
+    }
+
+    if (optind + 1 != argc) {
+        usage(argv[0], stderr);
+    }
+    output = argv[optind];
+
+    /* the header is included by its base name */
+    header = strrchr(output, '/');
+    header = header ? header + 1 : output;
+    if (!prefix) {
+        prefix = header;
+    }
+
+    /* the prefix must be a C identifier */
+    for (i = 0; prefix[i]; ++i) {
+        if (!(isalpha((unsigned char)prefix[i]) || prefix[i] == '_'
+                || (i && isdigit((unsigned char)prefix[i])))) {
+            break;
+        }
+    }
+    if (!i || prefix[i]) {
+        fprintf(stderr, "Hashids: Invalid prefix: %s (use -p)\n", prefix);
+        return EXIT_FAILURE;
+    }
+
+    /* initialize hashids */
+    hashids = hashids_init3(salt, min_hash_length, alphabet);
+
+    /* error checking */
+    if (!hashids) {
+        switch (hashids_errno) {
+            case HASHIDS_ERROR_ALLOC:
+                fputs("Hashids: Allocation failed\n", stderr);
+                break;
+            case HASHIDS_ERROR_ALPHABET_LENGTH:
+                fputs("Hashids: Alphabet is too short\n", stderr);
+                break;
+            case HASHIDS_ERROR_ALPHABET_SPACE:
+                fputs("Hashids: Alphabet contains whitespace characters\n",
+                    stderr);
+                break;
+            default:
+                fputs("Hashids: Unknown error\n", stderr);
+                break;
+        }
+
+        return EXIT_FAILURE;
+    }
+
+    for (number = ~0ull, max_digits = 1; number >= hashids->alphabet_length;
+            number /= hashids->alphabet_length) {
+        ++max_digits;
+    }
+
+    /* names */
+    length = strlen(output);
+    path = malloc(length + 3);
+    guard = malloc(strlen(prefix) + 3);
+    upper = malloc(strlen(prefix) + 1);
+    if (!path || !guard || !upper) {
+        fputs("Hashids: Allocation failed\n", stderr);
+        return EXIT_FAILURE;
+    }
+    for (i = 0; prefix[i]; ++i) {
+        upper[i] = (char)toupper((unsigned char)prefix[i]);
+    }
+    upper[i] = '\0';
+    sprintf(guard, "%s_H", upper);
+
+    /* <output>.h, then <output>.c including it */
+    sprintf(path, "%s.h", output);
+    ok = write_header(path, guard, prefix, upper, hashids, max_digits);
+    if (ok) {
+        p = malloc(strlen(header) + 3);
+        if (!p) {
+            fputs("Hashids: Allocation failed\n", stderr);
+            return EXIT_FAILURE;
+        }
+        sprintf(p, "%s.h", header);
+        sprintf(path, "%s.c", output);
+        ok = write_source(path, p, prefix, hashids);
+        free(p);
+    }
+    if (!ok) {
+        fprintf(stderr, "Hashids: Cannot write %s\n", path);
+    }
+
+    free(path);
+    free(guard);
+    free(upper);
+    hashids_free(hashids);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
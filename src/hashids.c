@@ -1,11 +1,34 @@
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <math.h>
+#include <limits.h>
+#include <sys/types.h>
 
 #include "hashids.h"
 
+#if HASHIDS_STATS
+#   include <pthread.h>
+#   include <time.h>
+#endif
+
+/* USDT probes (compiled in with --enable-usdt) */
+#if HASHIDS_USDT
+#   include <sys/sdt.h>
+#   define HASHIDS_PROBE1(name, a)          DTRACE_PROBE1(hashids, name, a)
+#   define HASHIDS_PROBE2(name, a, b)       DTRACE_PROBE2(hashids, name, a, b)
+#   define HASHIDS_PROBE3(name, a, b, c)    DTRACE_PROBE3(hashids, name, a, b, c)
+#else
+#   define HASHIDS_PROBE1(name, a)          do { } while (0)
+#   define HASHIDS_PROBE2(name, a, b)       do { } while (0)
+#   define HASHIDS_PROBE3(name, a, b, c)    do { } while (0)
+#endif
+
 #ifndef __has_builtin
 #   define __has_builtin(x) (0)
 #endif
@@ -18,7 +41,7 @@
 #endif
 
 /* exported hashids_errno */
-int hashids_errno;
+HASHIDS_STORAGE HASHIDS_THREAD_LOCAL int hashids_errno;
 
 /* alloc/free */
 static void *
@@ -33,8 +56,182 @@ hashids_free_f(void *ptr)
     free(ptr);
 }
 
-void *(*_hashids_alloc)(size_t size) = hashids_alloc_f;
-void (*_hashids_free)(void *ptr) = hashids_free_f;
+HASHIDS_STORAGE void *(*_hashids_alloc)(size_t size) = hashids_alloc_f;
+HASHIDS_STORAGE void (*_hashids_free)(void *ptr) = hashids_free_f;
+
+/* instrumentation counters */
+#if HASHIDS_STATS
+
+/* every thread owns a block; blocks of exited threads are folded in */
+struct hashids_stats_block_s {
+    hashids_stats_t stats;
+    struct hashids_stats_block_s *prev, *next;
+};
+
+#define HASHIDS_STATS_FIELDS (sizeof(hashids_stats_t) \
+    / sizeof(unsigned long long))
+
+static pthread_mutex_t hashids_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t hashids_stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t hashids_stats_key;
+static struct hashids_stats_block_s *hashids_stats_blocks;
+static hashids_stats_t hashids_stats_retired, hashids_stats_base;
+static __thread struct hashids_stats_block_s hashids_stats_block;
+static __thread int hashids_stats_registered;
+
+/* accumulate `src` into `dst`, field by field */
+static void
+hashids_stats_sum(hashids_stats_t *dst, hashids_stats_t *src)
+{
+    unsigned long long *d = (unsigned long long *)dst,
+        *s = (unsigned long long *)src;
+    size_t i;
+
+    for (i = 0; i < HASHIDS_STATS_FIELDS; ++i) {
+        d[i] += __atomic_load_n(&s[i], __ATOMIC_RELAXED);
+    }
+}
+
+/* thread exit: fold the block into the retired totals */
+static void
+hashids_stats_retire(void *ptr)
+{
+    struct hashids_stats_block_s *block = ptr;
+
+    pthread_mutex_lock(&hashids_stats_mutex);
+    hashids_stats_sum(&hashids_stats_retired, &block->stats);
+    if (block->prev) {
+        block->prev->next = block->next;
+    } else {
+        hashids_stats_blocks = block->next;
+    }
+    if (block->next) {
+        block->next->prev = block->prev;
+    }
+    pthread_mutex_unlock(&hashids_stats_mutex);
+}
+
+static void
+hashids_stats_key_init(void)
+{
+    pthread_key_create(&hashids_stats_key, hashids_stats_retire);
+}
+
+/* this thread's counters */
+static inline hashids_stats_t *
+hashids_stats_thread(void)
+{
+    struct hashids_stats_block_s *block = &hashids_stats_block;
+
+    if (HASHIDS_UNLIKELY(!hashids_stats_registered)) {
+        pthread_once(&hashids_stats_once, hashids_stats_key_init);
+        pthread_setspecific(hashids_stats_key, block);
+
+        pthread_mutex_lock(&hashids_stats_mutex);
+        block->prev = NULL;
+        block->next = hashids_stats_blocks;
+        if (block->next) {
+            block->next->prev = block;
+        }
+        hashids_stats_blocks = block;
+        pthread_mutex_unlock(&hashids_stats_mutex);
+
+        hashids_stats_registered = 1;
+    }
+
+    return &block->stats;
+}
+
+/* timestamp: TSC ticks where available, nanoseconds elsewhere */
+static inline unsigned long long
+hashids_stats_now(void)
+{
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    unsigned int lo, hi;
+
+    __asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((unsigned long long)hi << 32) | lo;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+/* only the owning thread writes, so a relaxed load/store pair will do */
+#   define HASHIDS_STATS_ADD(field, n) do {                                \
+        hashids_stats_t *stats_ = hashids_stats_thread();                  \
+        __atomic_store_n(&stats_->field, stats_->field + (n),              \
+            __ATOMIC_RELAXED);                                             \
+    } while (0)
+#   define HASHIDS_STATS_NOW() hashids_stats_now()
+#else
+#   define HASHIDS_STATS_ADD(field, n) do { } while (0)
+#   define HASHIDS_STATS_NOW() 0ull
+#endif
+
+/* count a finished call along with the time it took */
+#if HASHIDS_STATS
+#   define HASHIDS_STATS_CALL(calls, cycles, started) do {                 \
+        HASHIDS_STATS_ADD(calls, 1);                                       \
+        HASHIDS_STATS_ADD(cycles, HASHIDS_STATS_NOW() - (started));        \
+    } while (0)
+#else
+#   define HASHIDS_STATS_CALL(calls, cycles, started) ((void)(started))
+#endif
+
+/* snapshot, summed over all threads */
+int
+hashids_stats(hashids_stats_t *stats)
+{
+#if HASHIDS_STATS
+    struct hashids_stats_block_s *block;
+    unsigned long long *d = (unsigned long long *)stats,
+        *b = (unsigned long long *)&hashids_stats_base;
+    size_t i;
+
+    pthread_mutex_lock(&hashids_stats_mutex);
+    *stats = hashids_stats_retired;
+    for (block = hashids_stats_blocks; block; block = block->next) {
+        hashids_stats_sum(stats, &block->stats);
+    }
+    for (i = 0; i < HASHIDS_STATS_FIELDS; ++i) {
+        d[i] -= b[i];
+    }
+    pthread_mutex_unlock(&hashids_stats_mutex);
+
+    return 1;
+#else
+    memset(stats, 0, sizeof(hashids_stats_t));
+
+    return 0;
+#endif
+}
+
+/* reset: later snapshots count from here */
+void
+hashids_stats_reset(void)
+{
+#if HASHIDS_STATS
+    hashids_stats_t stats;
+
+    hashids_stats(&stats);
+
+    pthread_mutex_lock(&hashids_stats_mutex);
+    hashids_stats_sum(&hashids_stats_base, &stats);
+    pthread_mutex_unlock(&hashids_stats_mutex);
+#endif
+}
+
+/* reject a hash */
+static inline void
+hashids_invalid_hash(void)
+{
+    hashids_errno = HASHIDS_ERROR_INVALID_HASH;
+    HASHIDS_STATS_ADD(invalid_hashes, 1);
+    HASHIDS_PROBE1(invalid_hash, hashids_errno);
+}
 
 /* shuffle loop step */
 #define hashids_shuffle_step(iter) \
@@ -56,6 +253,8 @@ hashids_shuffle(char *str, size_t str_length, char *salt, size_t salt_length)
         return;
     }
 
+    HASHIDS_STATS_ADD(shuffles, 1);
+
     for (i = str_length - 1, v = 0, p = 0; i > 0; /* empty */) {
         switch (i % 32) {
             case 31: hashids_shuffle_step(i);
@@ -94,6 +293,217 @@ hashids_shuffle(char *str, size_t str_length, char *salt, size_t salt_length)
     }
 }
 
+/* encode cache: sets of HASHIDS_CACHE_WAYS slots; each slot is a sequence
+   number (odd while written), a header (numbers count << 32 | length), the
+   numbers and the hash, all in words read and written atomically */
+#define HASHIDS_CACHE_WAYS 4
+
+struct hashids_cache_s {
+    size_t sets_mask;
+    size_t max_numbers;
+    size_t hash_words;          /* room for the hash and its NUL */
+    size_t slot_words;
+    unsigned long long *slots;
+    unsigned int *victims;      /* next way to replace, per set */
+};
+
+/* free an encode cache */
+static void
+hashids_cache_free(struct hashids_cache_s *cache)
+{
+    if (cache) {
+        if (cache->slots) {
+            _hashids_free(cache->slots);
+        }
+        _hashids_free(cache);
+    }
+}
+
+/* size (or, with 0 entries, drop) the encode cache; not to be called while
+   other threads encode with the same instance */
+int
+hashids_cache_enable(hashids_t *hashids, size_t entries, size_t max_numbers)
+{
+    struct hashids_cache_s *cache;
+    size_t sets, digits;
+    unsigned long long number;
+
+    hashids_cache_free(hashids->cache);
+    hashids->cache = NULL;
+
+    if (!entries || !max_numbers) {
+        return 1;
+    }
+
+    cache = _hashids_alloc(sizeof(struct hashids_cache_s));
+    if (HASHIDS_UNLIKELY(!cache)) {
+        hashids_errno = HASHIDS_ERROR_ALLOC;
+        return 0;
+    }
+
+    for (sets = 1; sets * HASHIDS_CACHE_WAYS < entries; sets <<= 1) {
+        /* empty */
+    }
+
+    /* the longest hash of max_numbers numbers */
+    for (number = ~0ull, digits = 0; number; ++digits) {
+        number /= hashids->alphabet_length;
+    }
+    cache->hash_words = max_numbers * (digits + 1) + 1;
+    if (cache->hash_words < hashids->min_hash_length + 1) {
+        cache->hash_words = hashids->min_hash_length + 1;
+    }
+    cache->hash_words = (cache->hash_words + sizeof(number) - 1)
+        / sizeof(number);
+
+    /* lookups copy through a scratch buffer; longer hashes aren't cached */
+    if (cache->hash_words > HASHIDS_SCRATCH_SIZE / sizeof(number)) {
+        cache->hash_words = HASHIDS_SCRATCH_SIZE / sizeof(number);
+    }
+
+    cache->sets_mask = sets - 1;
+    cache->max_numbers = max_numbers;
+    cache->slot_words = 2 + max_numbers + cache->hash_words;
+    cache->slots = _hashids_alloc(sets * (HASHIDS_CACHE_WAYS
+        * cache->slot_words * sizeof(number) + sizeof(unsigned int)));
+    if (HASHIDS_UNLIKELY(!cache->slots)) {
+        hashids_cache_free(cache);
+        hashids_errno = HASHIDS_ERROR_ALLOC;
+        return 0;
+    }
+
+    /* all slots empty (numbers count 0) */
+    memset(cache->slots, 0, sets * (HASHIDS_CACHE_WAYS * cache->slot_words
+        * sizeof(number) + sizeof(unsigned int)));
+    cache->victims = (unsigned int *)(cache->slots
+        + sets * HASHIDS_CACHE_WAYS * cache->slot_words);
+
+    hashids->cache = cache;
+    return 1;
+}
+
+/* the first slot of the set of a numbers tuple */
+static inline unsigned long long *
+hashids_cache_set(struct hashids_cache_s *cache, size_t numbers_count,
+    unsigned long long *numbers)
+{
+    unsigned long long h = numbers_count;
+    size_t i;
+
+    for (i = 0; i < numbers_count; ++i) {
+        h = (h ^ numbers[i]) * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 29;
+    }
+
+    return cache->slots + (h & cache->sets_mask) * HASHIDS_CACHE_WAYS
+        * cache->slot_words;
+}
+
+/* copy a cached hash into buffer; returns its length, 0 on a miss */
+static size_t
+hashids_cache_lookup(struct hashids_cache_s *cache, char *buffer,
+    size_t numbers_count, unsigned long long *numbers)
+{
+    unsigned long long *slot, sequence, header, word;
+    char scratch[HASHIDS_SCRATCH_SIZE];
+    size_t i, way, length;
+
+    slot = hashids_cache_set(cache, numbers_count, numbers);
+    for (way = 0; way < HASHIDS_CACHE_WAYS; ++way, slot += cache->slot_words) {
+        sequence = __atomic_load_n(&slot[0], __ATOMIC_ACQUIRE);
+        if (sequence & 1) {
+            continue;
+        }
+
+        header = __atomic_load_n(&slot[1], __ATOMIC_RELAXED);
+        if (header >> 32 != numbers_count) {
+            continue;
+        }
+        for (i = 0; i < numbers_count; ++i) {
+            if (__atomic_load_n(&slot[2 + i], __ATOMIC_RELAXED)
+                    != numbers[i]) {
+                break;
+            }
+        }
+        if (i < numbers_count) {
+            continue;
+        }
+
+        /* a torn header may claim any length: copy into scratch first,
+           and into buffer only once the sequence proves it consistent */
+        length = header & 0xFFFFFFFFull;
+        if (length >= cache->hash_words * sizeof(word)) {
+            continue;
+        }
+        for (i = 0; i <= length; i += sizeof(word)) {
+            word = __atomic_load_n(&slot[2 + cache->max_numbers
+                + i / sizeof(word)], __ATOMIC_RELAXED);
+            memcpy(scratch + i, &word, sizeof(word));
+        }
+
+        /* torn by a concurrent store: a miss */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot[0], __ATOMIC_RELAXED) != sequence) {
+            return 0;
+        }
+
+        memcpy(buffer, scratch, length + 1);
+        return length;
+    }
+
+    return 0;
+}
+
+/* remember a hash, unless another thread is writing the victim slot */
+static void
+hashids_cache_store(struct hashids_cache_s *cache, const char *hash,
+    size_t length, size_t numbers_count, unsigned long long *numbers)
+{
+    unsigned long long *slot, sequence, word;
+    size_t i, chunk;
+
+    if (length >= cache->hash_words * sizeof(word)) {
+        return;
+    }
+
+    /* an empty way, or else the next one in turn */
+    slot = hashids_cache_set(cache, numbers_count, numbers);
+    for (i = 0; i < HASHIDS_CACHE_WAYS; ++i) {
+        if (!__atomic_load_n(&slot[i * cache->slot_words + 1],
+                __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+    if (i == HASHIDS_CACHE_WAYS) {
+        i = (slot - cache->slots) / (HASHIDS_CACHE_WAYS * cache->slot_words);
+        i = __atomic_fetch_add(&cache->victims[i], 1, __ATOMIC_RELAXED)
+            % HASHIDS_CACHE_WAYS;
+    }
+    slot += i * cache->slot_words;
+
+    sequence = __atomic_load_n(&slot[0], __ATOMIC_RELAXED);
+    if ((sequence & 1) || !__atomic_compare_exchange_n(&slot[0], &sequence,
+            sequence + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        return;
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    __atomic_store_n(&slot[1], (unsigned long long)numbers_count << 32
+        | length, __ATOMIC_RELAXED);
+    for (i = 0; i < numbers_count; ++i) {
+        __atomic_store_n(&slot[2 + i], numbers[i], __ATOMIC_RELAXED);
+    }
+    for (i = 0; i <= length; i += chunk) {
+        word = 0;
+        chunk = length + 1 - i < sizeof(word) ? length + 1 - i : sizeof(word);
+        memcpy(&word, hash + i, chunk);
+        __atomic_store_n(&slot[2 + cache->max_numbers + i / sizeof(word)],
+            word, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&slot[0], sequence + 2, __ATOMIC_RELEASE);
+}
+
 /* "destructor" */
 void
 hashids_free(hashids_t *hashids)
@@ -117,14 +527,16 @@ hashids_free(hashids_t *hashids)
         if (hashids->guards) {
             _hashids_free(hashids->guards);
         }
+        hashids_cache_free(hashids->cache);
 
         _hashids_free(hashids);
     }
 }
 
 /* common init */
-hashids_t *
-hashids_init3(const char *salt, size_t min_hash_length, const char *alphabet)
+static hashids_t *
+hashids_init_internal(const char *salt, size_t min_hash_length,
+    const char *alphabet)
 {
     hashids_t *result;
     size_t i, j, len;
@@ -138,6 +550,7 @@ hashids_init3(const char *salt, size_t min_hash_length, const char *alphabet)
         hashids_errno = HASHIDS_ERROR_ALLOC;
         return NULL;
     }
+    result->cache = NULL;
 
     /* allocate enough space for the alphabet */
     len = strlen(alphabet) + 1;
@@ -276,11 +689,9 @@ hashids_init3(const char *salt, size_t min_hash_length, const char *alphabet)
         result->alphabet_length -= result->guards_count;
     }
 
-    /* allocate enough space for the alphabet copies */
-    result->alphabet_copy_1 = _hashids_alloc(result->alphabet_length + 1);
-    result->alphabet_copy_2 = _hashids_alloc(result->alphabet_length + 1);
-    if (HASHIDS_UNLIKELY(!result->alphabet || !result->alphabet_copy_1
-        || !result->alphabet_copy_2)) {
+    /* the working alphabets live on the stack of each call, which keeps
+       encoding and decoding reentrant */
+    if (HASHIDS_UNLIKELY(!result->alphabet)) {
         hashids_free(result);
         hashids_errno = HASHIDS_ERROR_ALLOC;
         return NULL;
@@ -293,6 +704,19 @@ hashids_init3(const char *salt, size_t min_hash_length, const char *alphabet)
     return result;
 }
 
+/* common init (traced) */
+hashids_t *
+hashids_init3(const char *salt, size_t min_hash_length, const char *alphabet)
+{
+    hashids_t *result;
+
+    HASHIDS_PROBE3(init_entry, salt, min_hash_length, alphabet);
+    result = hashids_init_internal(salt, min_hash_length, alphabet);
+    HASHIDS_PROBE2(init_return, result, hashids_errno);
+
+    return result;
+}
+
 /* init with salt and minimum hash length */
 hashids_t *
 hashids_init2(const char *salt, size_t min_hash_length)
@@ -359,97 +783,78 @@ hashids_estimate_encoded_size_v(hashids_t *hashids,
     return result;
 }
 
-/* encode many (generic) */
-size_t
-hashids_encode(hashids_t *hashids, char *buffer,
-    size_t numbers_count, unsigned long long *numbers)
+/* prepare the iteration salt ("lottery + salt + alphabet") */
+static int
+hashids_salt_init(hashids_t *hashids, char *salt_buffer, char lottery)
 {
-    /* bail out if no numbers */
-    if (HASHIDS_UNLIKELY(!numbers_count)) {
-        buffer[0] = '\0';
-
-        return 0;
-    }
-
-    size_t i, j, result_len, guard_index, half_length_ceil, half_length_floor;
-    unsigned long long number, number_copy, numbers_hash;
     int p_max;
-    char lottery, ch, temp_ch, *p, *buffer_end, *buffer_temp;
 
-    /* return an estimation if no buffer */
-    if (HASHIDS_UNLIKELY(!buffer)) {
-        return hashids_estimate_encoded_size(hashids, numbers_count, numbers);
+    salt_buffer[0] = lottery;
+    salt_buffer[1] = '\0';
+    strncat(salt_buffer, hashids->salt, hashids->alphabet_length - 1);
+    p_max = hashids->alphabet_length - 1 - hashids->salt_length;
+    if (p_max > 0) {
+        strncat(salt_buffer, hashids->alphabet, p_max);
+    } else {
+        salt_buffer[hashids->alphabet_length] = '\0';
     }
 
-    /* copy the alphabet into internal buffer 1 */
-    strncpy(hashids->alphabet_copy_1, hashids->alphabet,
-        hashids->alphabet_length);
+    return p_max;
+}
 
-    /* walk arguments once and generate a hash */
-    for (i = 0, numbers_hash = 0; i < numbers_count; ++i) {
-        number = numbers[i];
-        numbers_hash += number % (i + 100);
+/* re-salt and shuffle the working alphabet before each number */
+static inline void
+hashids_salt_shuffle(hashids_t *hashids, char *alphabet, char *salt_buffer,
+    int p_max)
+{
+    if (p_max > 0) {
+        memcpy(salt_buffer + hashids->salt_length + 1, alphabet, p_max);
     }
 
-    /* lottery character */
-    lottery = hashids->alphabet[numbers_hash % hashids->alphabet_length];
+    hashids_shuffle(alphabet, hashids->alphabet_length, salt_buffer,
+        hashids->alphabet_length);
+}
 
-    /* start output buffer with it (or don't) */
-    buffer[0] = lottery;
-    buffer_end = buffer + 1;
+/* reverse a string in place */
+static inline void
+hashids_reverse(char *begin, char *end)
+{
+    char temp_ch;
 
-    /* alphabet-like buffer used for salt at each iteration */
-    hashids->alphabet_copy_2[0] = lottery;
-    hashids->alphabet_copy_2[1] = '\0';
-    strncat(hashids->alphabet_copy_2, hashids->salt,
-        hashids->alphabet_length - 1);
-    p = hashids->alphabet_copy_2 + hashids->salt_length + 1;
-    p_max = hashids->alphabet_length - 1 - hashids->salt_length;
-    if (p_max > 0) {
-        strncat(hashids->alphabet_copy_2, hashids->alphabet,
-            p_max);
-    } else {
-        hashids->alphabet_copy_2[hashids->alphabet_length] = '\0';
+    for (--end; begin < end; ++begin, --end) {
+        temp_ch = *begin;
+        *begin = *end;
+        *end = temp_ch;
     }
+}
 
-    for (i = 0; i < numbers_count; ++i) {
-        /* take number */
-        number = number_copy = numbers[i];
-
-        /* create a salt for this iteration */
-        if (p_max > 0) {
-            strncpy(p, hashids->alphabet_copy_1, p_max);
-        }
-
-        /* shuffle the alphabet */
-        hashids_shuffle(hashids->alphabet_copy_1, hashids->alphabet_length,
-            hashids->alphabet_copy_2, hashids->alphabet_length);
+/* write the digits of a number, most significant first */
+static inline char *
+hashids_encode_digits(hashids_t *hashids, const char *alphabet,
+    unsigned long long number, char *buffer)
+{
+    char *p = buffer;
 
-        /* hash the number */
-        buffer_temp = buffer_end;
-        do {
-            ch = hashids->alphabet_copy_1[number % hashids->alphabet_length];
-            *buffer_end++ = ch;
-            number /= hashids->alphabet_length;
-        } while (number);
+    do {
+        *p++ = alphabet[number % hashids->alphabet_length];
+        number /= hashids->alphabet_length;
+    } while (number);
 
-        /* reverse the hash we got */
-        for (j = 0; j < (buffer_end - buffer_temp) / 2; ++j) {
-            temp_ch = *(buffer_temp + j);
-            *(buffer_temp + j) = *(buffer_end - 1 - j);
-            *(buffer_end - 1 - j) = temp_ch;
-        }
+    /* reverse the hash we got */
+    hashids_reverse(buffer, p);
 
-        if (i + 1 < numbers_count) {
-            number_copy %= ch + i;
-            *buffer_end = hashids->separators[number_copy %
-                hashids->separators_count];
-            ++buffer_end;
-        }
-    }
+    return p;
+}
 
-    /* intermediate string length */
-    result_len = buffer_end - buffer;
+/* add guards and padding up to min_hash_length; *offset (if given) is where
+   the unpadded hash ends up */
+static size_t
+hashids_encode_pad_at(hashids_t *hashids, char *buffer, size_t result_len,
+    unsigned long long numbers_hash, char *alphabet, char *scratch,
+    size_t *offset)
+{
+    size_t i, j, guard_index, half_length_ceil, half_length_floor,
+        left = 0;
 
     if (result_len < hashids->min_hash_length) {
         /* add a guard before the encoded numbers */
@@ -457,6 +862,7 @@ hashids_encode(hashids_t *hashids, char *buffer,
         memmove(buffer + 1, buffer, result_len);
         buffer[0] = hashids->guards[guard_index];
         ++result_len;
+        ++left;
 
         if (result_len < hashids->min_hash_length) {
             /* add a guard after the encoded numbers */
@@ -470,11 +876,11 @@ hashids_encode(hashids_t *hashids, char *buffer,
 
             /* pad, pad, pad */
             while (result_len < hashids->min_hash_length) {
+                HASHIDS_STATS_ADD(padding_iterations, 1);
+
                 /* shuffle the alphabet */
-                strncpy(hashids->alphabet_copy_2, hashids->alphabet_copy_1,
-                    hashids->alphabet_length);
-                hashids_shuffle(hashids->alphabet_copy_1,
-                    hashids->alphabet_length, hashids->alphabet_copy_2,
+                memcpy(scratch, alphabet, hashids->alphabet_length);
+                hashids_shuffle(alphabet, hashids->alphabet_length, scratch,
                     hashids->alphabet_length);
 
                 /* left pad from the end of the alphabet */
@@ -498,43 +904,156 @@ hashids_encode(hashids_t *hashids, char *buffer,
                 /* move the current result to "center" */
                 memmove(buffer + i, buffer, result_len);
                 /* pad left */
-                memmove(buffer,
-                    hashids->alphabet_copy_1 + hashids->alphabet_length - i, i);
+                memmove(buffer, alphabet + hashids->alphabet_length - i, i);
                 /* pad right */
-                memmove(buffer + i + result_len, hashids->alphabet_copy_1, j);
+                memmove(buffer + i + result_len, alphabet, j);
 
                 /* increment result_len */
                 result_len += i + j;
+                left += i;
             }
         }
     }
 
+    if (offset) {
+        *offset = left;
+    }
+
     buffer[result_len] = '\0';
     return result_len;
 }
 
-/* encode many (variadic) */
+/* add guards and padding up to min_hash_length */
+static inline size_t
+hashids_encode_pad(hashids_t *hashids, char *buffer, size_t result_len,
+    unsigned long long numbers_hash, char *alphabet, char *scratch)
+{
+    return hashids_encode_pad_at(hashids, buffer, result_len, numbers_hash,
+        alphabet, scratch, NULL);
+}
+
+/* encode many (generic) */
 size_t
-hashids_encode_v(hashids_t *hashids, char *buffer,
-    size_t numbers_count, ...)
+hashids_encode(hashids_t *hashids, char *buffer,
+    size_t numbers_count, unsigned long long *numbers)
 {
-    int i;
-    size_t result;
-    unsigned long long *numbers;
-    va_list ap;
+    char alphabet_copy_1[HASHIDS_SCRATCH_SIZE],
+        alphabet_copy_2[HASHIDS_SCRATCH_SIZE];
+    HASHIDS_PROBE1(encode_entry, numbers_count);
 
-    numbers = _hashids_alloc(numbers_count * sizeof(unsigned long long));
+    /* bail out if no numbers */
+    if (HASHIDS_UNLIKELY(!numbers_count)) {
+        buffer[0] = '\0';
 
-    if (HASHIDS_UNLIKELY(!numbers)) {
-        hashids_errno = HASHIDS_ERROR_ALLOC;
+        HASHIDS_PROBE2(encode_return, numbers_count, 0);
         return 0;
     }
 
-    va_start(ap, numbers_count);
-    for (i = 0; i < numbers_count; ++i) {
-        numbers[i] = va_arg(ap, unsigned long long);
+    size_t i, result_len;
+    unsigned long long number, numbers_hash,
+        started = HASHIDS_STATS_NOW();
+    int p_max;
+    char lottery, *buffer_end, *buffer_temp;
+
+    /* return an estimation if no buffer */
+    if (HASHIDS_UNLIKELY(!buffer)) {
+        result_len = hashids_estimate_encoded_size(hashids, numbers_count,
+            numbers);
+
+        HASHIDS_PROBE2(encode_return, numbers_count, result_len);
+        return result_len;
     }
-    va_end(ap);
+
+    /* hot tuples: the optional cache */
+    if (hashids->cache && numbers_count <= hashids->cache->max_numbers) {
+        result_len = hashids_cache_lookup(hashids->cache, buffer,
+            numbers_count, numbers);
+        if (result_len) {
+            HASHIDS_STATS_ADD(cache_hits, 1);
+            HASHIDS_STATS_CALL(encodes, encode_cycles, started);
+            HASHIDS_PROBE2(encode_return, numbers_count, result_len);
+            return result_len;
+        }
+        HASHIDS_STATS_ADD(cache_misses, 1);
+    }
+
+    /* copy the alphabet into internal buffer 1 */
+    memcpy(alphabet_copy_1, hashids->alphabet,
+        hashids->alphabet_length + 1);
+
+    /* walk arguments once and generate a hash */
+    for (i = 0, numbers_hash = 0; i < numbers_count; ++i) {
+        number = numbers[i];
+        numbers_hash += number % (i + 100);
+    }
+
+    /* lottery character */
+    lottery = hashids->alphabet[numbers_hash % hashids->alphabet_length];
+
+    /* start output buffer with it (or don't) */
+    buffer[0] = lottery;
+    buffer_end = buffer + 1;
+
+    /* alphabet-like buffer used for salt at each iteration */
+    p_max = hashids_salt_init(hashids, alphabet_copy_2, lottery);
+
+    for (i = 0; i < numbers_count; ++i) {
+        /* take number */
+        number = numbers[i];
+
+        /* shuffle the alphabet */
+        hashids_salt_shuffle(hashids, alphabet_copy_1,
+            alphabet_copy_2, p_max);
+
+        /* hash the number */
+        buffer_temp = buffer_end;
+        buffer_end = hashids_encode_digits(hashids, alphabet_copy_1,
+            number, buffer_end);
+
+        if (i + 1 < numbers_count) {
+            number %= *buffer_temp + i;
+            *buffer_end = hashids->separators[number %
+                hashids->separators_count];
+            ++buffer_end;
+        }
+    }
+
+    /* guards & padding */
+    result_len = hashids_encode_pad(hashids, buffer, buffer_end - buffer,
+        numbers_hash, alphabet_copy_1, alphabet_copy_2);
+
+    if (hashids->cache && numbers_count <= hashids->cache->max_numbers) {
+        hashids_cache_store(hashids->cache, buffer, result_len,
+            numbers_count, numbers);
+    }
+
+    HASHIDS_STATS_CALL(encodes, encode_cycles, started);
+    HASHIDS_PROBE2(encode_return, numbers_count, result_len);
+    return result_len;
+}
+
+/* encode many (variadic) */
+size_t
+hashids_encode_v(hashids_t *hashids, char *buffer,
+    size_t numbers_count, ...)
+{
+    int i;
+    size_t result;
+    unsigned long long *numbers;
+    va_list ap;
+
+    numbers = _hashids_alloc(numbers_count * sizeof(unsigned long long));
+
+    if (HASHIDS_UNLIKELY(!numbers)) {
+        hashids_errno = HASHIDS_ERROR_ALLOC;
+        return 0;
+    }
+
+    va_start(ap, numbers_count);
+    for (i = 0; i < numbers_count; ++i) {
+        numbers[i] = va_arg(ap, unsigned long long);
+    }
+    va_end(ap);
 
     result = hashids_encode(hashids, buffer, numbers_count, numbers);
     _hashids_free(numbers);
@@ -550,43 +1069,252 @@ hashids_encode_one(hashids_t *hashids, char *buffer,
     return hashids_encode(hashids, buffer, 1, &number);
 }
 
-/* numbers count */
+/* single numbers cycle through this many lotteries (numbers_hash = n % 100) */
+#define HASHIDS_RANGE_CYCLE 100
+
+/* per-lottery state of a range iterator */
+struct hashids_range_residue_s {
+    int shuffled;
+    size_t pad_digits;          /* digits count the template is for */
+    size_t pad_offset;          /* the lottery's index in the template */
+    size_t pad_length;
+};
+
+/* range iterator */
+struct hashids_range_s {
+    hashids_t *hashids;
+    unsigned long long next, end;
+    unsigned int residue;       /* next % HASHIDS_RANGE_CYCLE */
+    size_t digits_count;
+    unsigned char digits[64];   /* next, least significant digit first */
+    struct hashids_range_residue_s residues[HASHIDS_RANGE_CYCLE];
+    char *alphabets;            /* the shuffled alphabet of each residue */
+    char *templates;            /* a padded hash of each residue */
+};
+
+/* iterate over the hashes of [start, end) */
+hashids_range_t *
+hashids_range_init(hashids_t *hashids, unsigned long long start,
+    unsigned long long end)
+{
+    hashids_range_t *range;
+    size_t template_size = hashids->min_hash_length
+        ? hashids->min_hash_length + 1 : 0;
+    unsigned long long number;
+
+    range = _hashids_alloc(sizeof(hashids_range_t) + HASHIDS_RANGE_CYCLE
+        * (hashids->alphabet_length + template_size));
+    if (HASHIDS_UNLIKELY(!range)) {
+        hashids_errno = HASHIDS_ERROR_ALLOC;
+        return NULL;
+    }
+
+    memset(range->residues, 0, sizeof(range->residues));
+    range->alphabets = (char *)(range + 1);
+    range->templates = range->alphabets
+        + HASHIDS_RANGE_CYCLE * hashids->alphabet_length;
+
+    range->hashids = hashids;
+    range->next = start;
+    range->end = end;
+    range->residue = start % HASHIDS_RANGE_CYCLE;
+
+    /* the only division: split start into digits */
+    number = start;
+    range->digits_count = 0;
+    do {
+        range->digits[range->digits_count++] =
+            number % hashids->alphabet_length;
+        number /= hashids->alphabet_length;
+    } while (number);
+
+    return range;
+}
+
+/* free a range iterator */
+void
+hashids_range_free(hashids_range_t *range)
+{
+    if (range) {
+        _hashids_free(range);
+    }
+}
+
+/* shuffle the alphabet of a residue, once */
+static char *
+hashids_range_alphabet(hashids_range_t *range, unsigned int residue)
+{
+    hashids_t *hashids = range->hashids;
+    char salt[HASHIDS_SCRATCH_SIZE], *alphabet;
+    int p_max;
+
+    alphabet = range->alphabets + residue * hashids->alphabet_length;
+    if (!range->residues[residue].shuffled) {
+        memcpy(alphabet, hashids->alphabet, hashids->alphabet_length);
+        p_max = hashids_salt_init(hashids, salt,
+            hashids->alphabet[residue % hashids->alphabet_length]);
+        hashids_salt_shuffle(hashids, alphabet, salt, p_max);
+        range->residues[residue].shuffled = 1;
+    }
+
+    return alphabet;
+}
+
+/* write the next hash; returns its length, 0 past the end */
 size_t
-hashids_numbers_count(hashids_t *hashids, char *str)
+hashids_range_next(hashids_range_t *range, char *buffer)
+{
+    hashids_t *hashids = range->hashids;
+    struct hashids_range_residue_s *residue;
+    char alphabet_copy[HASHIDS_SCRATCH_SIZE], scratch[HASHIDS_SCRATCH_SIZE];
+    const char *alphabet;
+    char *p, *template;
+    size_t i, result_len;
+    unsigned long long started = HASHIDS_STATS_NOW();
+
+    if (range->next >= range->end) {
+        buffer[0] = '\0';
+        return 0;
+    }
+
+    residue = &range->residues[range->residue];
+    alphabet = hashids_range_alphabet(range, range->residue);
+
+    /* lottery and digits, most significant first */
+    result_len = 1 + range->digits_count;
+    if (result_len < hashids->min_hash_length
+            && residue->pad_digits == range->digits_count) {
+        /* the padding only depends on the residue and the digits count */
+        template = range->templates
+            + range->residue * (hashids->min_hash_length + 1);
+        memcpy(buffer, template, residue->pad_length + 1);
+        p = buffer + residue->pad_offset;
+    } else {
+        p = buffer;
+    }
+
+    *p++ = hashids->alphabet[range->residue % hashids->alphabet_length];
+    for (i = range->digits_count; i--;) {
+        *p++ = alphabet[range->digits[i]];
+    }
+
+    if (result_len < hashids->min_hash_length) {
+        if (residue->pad_digits == range->digits_count) {
+            /* the second guard depends on the first digit */
+            if (result_len + 1 < hashids->min_hash_length) {
+                *p = hashids->guards[((unsigned long long)range->residue
+                    + buffer[residue->pad_offset + 1])
+                    % hashids->guards_count];
+            }
+            result_len = residue->pad_length;
+        } else {
+            /* pad for real, and keep the result as a template */
+            memcpy(alphabet_copy, alphabet, hashids->alphabet_length);
+            result_len = hashids_encode_pad_at(hashids, buffer, result_len,
+                range->residue, alphabet_copy, scratch,
+                &residue->pad_offset);
+            template = range->templates
+                + range->residue * (hashids->min_hash_length + 1);
+            memcpy(template, buffer, result_len + 1);
+            residue->pad_digits = range->digits_count;
+            residue->pad_length = result_len;
+        }
+    } else {
+        *p = '\0';
+    }
+
+    /* step: carry through the digits, no division */
+    ++range->next;
+    if (++range->residue == HASHIDS_RANGE_CYCLE) {
+        range->residue = 0;
+    }
+    for (i = 0; i < range->digits_count; ++i) {
+        if (++range->digits[i] < hashids->alphabet_length) {
+            break;
+        }
+        range->digits[i] = 0;
+    }
+    if (i == range->digits_count) {
+        range->digits[range->digits_count++] = 1;
+    }
+
+    HASHIDS_STATS_CALL(encodes, encode_cycles, started);
+    return result_len;
+}
+
+/* skip the padding up to (and including) the first guard */
+static inline char *
+hashids_skip_guard(hashids_t *hashids, char *str)
 {
-    size_t numbers_count;
     char ch, *p;
 
-    /* skip characters until we find a guard */
     if (hashids->min_hash_length) {
-        p = str;
-        while ((ch = *p)) {
+        for (p = str; (ch = *p); ++p) {
             if (strchr(hashids->guards, ch)) {
-                str = p + 1;
-                break;
+                return p + 1;
             }
+        }
+    }
+
+    return str;
+}
+
+/* skip the padding of str[0..end) up to (and including) the first guard */
+static inline const char *
+hashids_skip_guard_n(hashids_t *hashids, const char *str, const char *end)
+{
+    const char *p;
 
-            p++;
+    if (hashids->min_hash_length) {
+        for (p = str; p < end; ++p) {
+            if (strchr(hashids->guards, *p)) {
+                return p + 1;
+            }
         }
     }
 
-    /* parse */
+    return str;
+}
+
+/* numbers count */
+size_t
+hashids_numbers_count(hashids_t *hashids, char *str)
+{
+    return hashids_numbers_count_n(hashids, str, strlen(str));
+}
+
+/* numbers count (length-delimited) */
+size_t
+hashids_numbers_count_n(hashids_t *hashids, const char *str, size_t length)
+{
+    size_t numbers_count;
+    const char *end = str + length;
+    char ch;
+
+    /* skip characters until we find a guard */
+    str = hashids_skip_guard_n(hashids, str, end);
+
+    /* an empty hash (the encoding of no numbers) */
+    if (str == end || !*str) {
+        return 0;
+    }
+
+    /* parse; a NUL byte ends the hash like a guard does */
     numbers_count = 0;
-    while ((ch = *str)) {
+    for (; str < end; ++str) {
+        ch = *str;
+
         if (strchr(hashids->guards, ch)) {
             break;
         }
         if (strchr(hashids->separators, ch)) {
             numbers_count++;
-            str++;
             continue;
         }
         if (!strchr(hashids->alphabet, ch)) {
-            hashids_errno = HASHIDS_ERROR_INVALID_HASH;
+            hashids_invalid_hash();
             return 0;
         }
-
-        str++;
     }
 
     /* account for the last number */
@@ -598,170 +1326,1650 @@ size_t
 hashids_decode(hashids_t *hashids, char *str,
     unsigned long long *numbers)
 {
-    size_t numbers_count;
-    unsigned long long number;
-    char lottery, ch, *p, *c;
+    return hashids_decode_n(hashids, str, strlen(str), numbers);
+}
+
+/* decode (length-delimited) */
+size_t
+hashids_decode_n(hashids_t *hashids, const char *str, size_t length,
+    unsigned long long *numbers)
+{
+    char alphabet_copy_1[HASHIDS_SCRATCH_SIZE],
+        alphabet_copy_2[HASHIDS_SCRATCH_SIZE];
+    size_t numbers_count, n;
+    unsigned long long number, started = HASHIDS_STATS_NOW();
+    const char *end = str + length;
+    char lottery, ch, *c;
     int p_max;
 
-    numbers_count = hashids_numbers_count(hashids, str);
+    HASHIDS_PROBE1(decode_entry, str);
+
+    numbers_count = hashids_numbers_count_n(hashids, str, length);
 
-    if (!numbers) {
+    if (!numbers || !numbers_count) {
+        HASHIDS_PROBE2(decode_return, numbers_count,
+            numbers_count ? HASHIDS_ERROR_OK : hashids_errno);
         return numbers_count;
     }
 
     /* skip characters until we find a guard */
-    if (hashids->min_hash_length) {
-        p = str;
-        while ((ch = *p)) {
-            if (strchr(hashids->guards, ch)) {
-                str = p + 1;
-                break;
-            }
+    str = hashids_skip_guard_n(hashids, str, end);
 
-            p++;
-        }
+    /* an empty hash (the encoding of no numbers) */
+    if (str == end || !*str) {
+        HASHIDS_PROBE2(decode_return, 0, HASHIDS_ERROR_OK);
+        return 0;
     }
 
     /* get the lottery character */
     lottery = *str++;
 
     /* copy the alphabet into internal buffer 1 */
-    strncpy(hashids->alphabet_copy_1, hashids->alphabet,
-        hashids->alphabet_length);
+    memcpy(alphabet_copy_1, hashids->alphabet,
+        hashids->alphabet_length + 1);
 
     /* alphabet-like buffer used for salt at each iteration */
-    hashids->alphabet_copy_2[0] = lottery;
-    hashids->alphabet_copy_2[1] = '\0';
-    strncat(hashids->alphabet_copy_2, hashids->salt,
-        hashids->alphabet_length - 1);
-    p = hashids->alphabet_copy_2 + hashids->salt_length + 1;
-    p_max = hashids->alphabet_length - 1 - hashids->salt_length;
-    if (p_max > 0) {
-        strncat(hashids->alphabet_copy_2, hashids->alphabet,
-            p_max);
-    } else {
-        hashids->alphabet_copy_2[hashids->alphabet_length] = '\0';
-    }
+    p_max = hashids_salt_init(hashids, alphabet_copy_2, lottery);
 
     /* first shuffle */
-    hashids_shuffle(hashids->alphabet_copy_1, hashids->alphabet_length,
-        hashids->alphabet_copy_2, hashids->alphabet_length);
+    hashids_salt_shuffle(hashids, alphabet_copy_1,
+        alphabet_copy_2, p_max);
 
-    /* parse */
+    /* parse; a guard taken for the lottery hides the rest of the hash from
+       the count, so nothing is stored past it */
     number = 0;
-    while ((ch = *str)) {
+    for (n = 0; str < end; ++str) {
+        ch = *str;
+
         if (strchr(hashids->guards, ch)) {
             break;
         }
         if (strchr(hashids->separators, ch)) {
-            *numbers++ = number;
+            if (n < numbers_count) {
+                numbers[n] = number;
+            }
+            ++n;
             number = 0;
 
             /* resalt the alphabet */
-            if (p_max > 0) {
-                strncpy(p, hashids->alphabet_copy_1, p_max);
-            }
-            hashids_shuffle(hashids->alphabet_copy_1, hashids->alphabet_length,
-                hashids->alphabet_copy_2, hashids->alphabet_length);
-
-            str++;
+            hashids_salt_shuffle(hashids, alphabet_copy_1,
+                alphabet_copy_2, p_max);
             continue;
         }
-        if (!(c = strchr(hashids->alphabet_copy_1, ch))) {
-            hashids_errno = HASHIDS_ERROR_INVALID_HASH;
+        if (!(c = strchr(alphabet_copy_1, ch))) {
+            hashids_invalid_hash();
+            HASHIDS_PROBE2(decode_return, 0, hashids_errno);
             return 0;
         }
 
         number *= hashids->alphabet_length;
-        number += c - hashids->alphabet_copy_1;
-
-        str++;
+        number += c - alphabet_copy_1;
     }
 
     /* store last number */
-    *numbers = number;
+    if (n < numbers_count) {
+        numbers[n] = number;
+    }
 
+    HASHIDS_STATS_CALL(decodes, decode_cycles, started);
+    HASHIDS_PROBE2(decode_return, numbers_count, HASHIDS_ERROR_OK);
     return numbers_count;
 }
 
-/* encode hex */
+/* decode, accepting only what hashids_encode() would output */
 size_t
-hashids_encode_hex(hashids_t *hashids, char *buffer,
-    const char *hex_str)
+hashids_decode_strict(hashids_t *hashids, const char *str,
+    unsigned long long *numbers, size_t numbers_max)
 {
-    int len;
-    char *temp, *p;
-    size_t result;
-    unsigned long long number;
+    return hashids_decode_strict_n(hashids, str, strlen(str), numbers,
+        numbers_max);
+}
+
+/* strict decode into `*error`, leaving hashids_errno and the invalid hash
+   counters alone: the checks reuse the decoder's shuffle state, so only
+   padding costs extra shuffles */
+static size_t
+hashids_decode_strict_at(hashids_t *hashids, const char *str, size_t length,
+    unsigned long long *numbers, size_t numbers_max, int *error)
+{
+    char alphabet_copy_1[HASHIDS_SCRATCH_SIZE],
+        alphabet_copy_2[HASHIDS_SCRATCH_SIZE],
+        padded_stack[HASHIDS_SCRATCH_SIZE], *padded = padded_stack;
+    size_t i, numbers_count = 0, result_len;
+    unsigned long long number, numbers_hash,
+        started = HASHIDS_STATS_NOW();
+    const char *begin, *digits, *p, *end = str + length;
+    char lottery, ch, *c;
+    int p_max;
 
-    len = strlen(hex_str);
-    temp = _hashids_alloc(len + 2);
+    *error = HASHIDS_ERROR_OK;
 
-    if (!temp) {
-        hashids_errno = HASHIDS_ERROR_ALLOC;
+    /* an empty hash (the encoding of no numbers) */
+    if (!length) {
         return 0;
     }
 
-    temp[0] = '1';
-    strncpy(temp + 1, hex_str, len);
+    /* the lottery character must come from the alphabet */
+    begin = hashids_skip_guard_n(hashids, str, end);
+    if (begin == end || !*begin || !strchr(hashids->alphabet, *begin)) {
+        goto invalid;
+    }
+    lottery = *begin;
 
-    number = strtoull(temp, &p, 16);
+    /* copy the alphabet into internal buffer 1 */
+    memcpy(alphabet_copy_1, hashids->alphabet,
+        hashids->alphabet_length + 1);
 
-    if (p == temp) {
-        _hashids_free(temp);
-        hashids_errno = HASHIDS_ERROR_INVALID_NUMBER;
-        return 0;
-    }
+    /* alphabet-like buffer used for salt at each iteration */
+    p_max = hashids_salt_init(hashids, alphabet_copy_2, lottery);
 
-    result = hashids_encode(hashids, buffer, 1, &number);
-    _hashids_free(temp);
+    /* first shuffle */
+    hashids_salt_shuffle(hashids, alphabet_copy_1,
+        alphabet_copy_2, p_max);
 
-    return result;
-}
+    /* parse, checking each number as it ends */
+    number = 0;
+    for (digits = p = begin + 1;; ++p) {
+        ch = p < end ? *p : '\0';
+
+        if (p == end || strchr(hashids->guards, ch)
+                || strchr(hashids->separators, ch)) {
+            /* at least one digit, and no leading zeros */
+            if (p == digits || (p - digits > 1
+                    && *digits == alphabet_copy_1[0])) {
+                goto invalid;
+            }
+            if (numbers_count == numbers_max) {
+                *error = HASHIDS_ERROR_OVERFLOW;
+                numbers_count = 0;
+                goto cleanup;
+            }
+            numbers[numbers_count++] = number;
 
-/* decode hex */
-size_t
-hashids_decode_hex(hashids_t *hashids, char *str, char *output)
-{
-    size_t result, i;
-    unsigned long long number;
-    char ch, *temp;
+            if (p == end || strchr(hashids->guards, ch)) {
+                break;
+            }
 
-    result = hashids_numbers_count(hashids, str);
+            /* the separator hashids_encode() would pick */
+            i = numbers_count - 1;
+            number %= *digits + i;
+            if (ch != hashids->separators[number
+                    % hashids->separators_count]) {
+                goto invalid;
+            }
 
-    if (result != 1) {
-        return 0;
-    }
+            number = 0;
+            digits = p + 1;
 
-    result = hashids_decode(hashids, str, &number);
+            /* resalt the alphabet */
+            hashids_salt_shuffle(hashids, alphabet_copy_1,
+                alphabet_copy_2, p_max);
+            continue;
+        }
 
-    if (result != 1) {
-        return 0;
+        if (!(c = strchr(alphabet_copy_1, ch))) {
+            goto invalid;
+        }
+
+        /* wrapping around would decode to other numbers */
+        if (number > (~0ull - (c - alphabet_copy_1))
+                / hashids->alphabet_length) {
+            goto invalid;
+        }
+        number *= hashids->alphabet_length;
+        number += c - alphabet_copy_1;
     }
 
-    temp = output;
+    /* the lottery the numbers draw */
+    for (i = 0, numbers_hash = 0; i < numbers_count; ++i) {
+        numbers_hash += numbers[i] % (i + 100);
+    }
+    if (lottery != hashids->alphabet[numbers_hash
+            % hashids->alphabet_length]) {
+        goto invalid;
+    }
 
-    do {
-        ch = number % 16;
-        if (ch > 9) {
-            ch += 'A' - 10;
-        } else {
-            ch += '0';
+    /* no padding unless too short, and then exactly hashids_encode()'s,
+       grown from the alphabet as the last number left it */
+    result_len = p - begin;
+    if (result_len >= hashids->min_hash_length) {
+        if (begin != str || p != end) {
+            goto invalid;
         }
+    } else {
+        if (length != hashids->min_hash_length) {
+            goto invalid;
+        }
+        if (length + 1 > sizeof(padded_stack)) {
+            padded = _hashids_alloc(length + 1);
+            if (HASHIDS_UNLIKELY(!padded)) {
+                *error = HASHIDS_ERROR_ALLOC;
+                numbers_count = 0;
+                goto cleanup;
+            }
+        }
+        memcpy(padded, begin, result_len);
+        hashids_encode_pad(hashids, padded, result_len, numbers_hash,
+            alphabet_copy_1, alphabet_copy_2);
+        if (memcmp(padded, str, length)) {
+            goto invalid;
+        }
+    }
 
-        *temp++ = (char)ch;
-
-        number /= 16;
-    } while (number);
+    HASHIDS_STATS_CALL(decodes, decode_cycles, started);
+    goto cleanup;
 
-    temp--;
-    *temp = 0;
+invalid:
+    *error = HASHIDS_ERROR_INVALID_HASH;
+    numbers_count = 0;
 
-    for (i = 0; i < (temp - output) / 2; ++i) {
-        ch = *(output + i);
-        *(output + i) = *(temp - 1 - i);
-        *(temp - 1 - i) = ch;
+cleanup:
+    if (padded != padded_stack) {
+        _hashids_free(padded);
     }
 
-    return 1;
+    return numbers_count;
+}
+
+/* strict decode (length-delimited) */
+size_t
+hashids_decode_strict_n(hashids_t *hashids, const char *str, size_t length,
+    unsigned long long *numbers, size_t numbers_max)
+{
+    size_t numbers_count;
+    int error;
+
+    HASHIDS_PROBE1(decode_entry, str);
+
+    numbers_count = hashids_decode_strict_at(hashids, str, length, numbers,
+        numbers_max, &error);
+
+    if (error == HASHIDS_ERROR_INVALID_HASH) {
+        hashids_invalid_hash();
+    } else if (error) {
+        hashids_errno = error;
+    }
+
+    HASHIDS_PROBE2(decode_return, numbers_count, error);
+    return numbers_count;
+}
+
+/* incremental decoder states */
+#define HASHIDS_DECODER_LOTTERY 0
+#define HASHIDS_DECODER_NUMBER 1
+#define HASHIDS_DECODER_END 2
+#define HASHIDS_DECODER_EMPTY 3
+
+/* forget everything parsed so far */
+static void
+hashids_decoder_restart(hashids_decoder_t *decoder)
+{
+    decoder->numbers_stored = 0;
+    decoder->separators = 0;
+    decoder->number = 0;
+    decoder->state = HASHIDS_DECODER_LOTTERY;
+    decoder->counting = 1;
+    decoder->invalid = 0;
+}
+
+/* the lottery character: prepare the salt and the first shuffle */
+static void
+hashids_decoder_lottery(hashids_decoder_t *decoder, char lottery)
+{
+    hashids_t *hashids = decoder->hashids;
+
+    memcpy(decoder->alphabet, hashids->alphabet,
+        hashids->alphabet_length + 1);
+    decoder->p_max = hashids_salt_init(hashids, decoder->salt, lottery);
+    hashids_salt_shuffle(hashids, decoder->alphabet, decoder->salt,
+        decoder->p_max);
+    decoder->state = HASHIDS_DECODER_NUMBER;
+}
+
+/* store the parsed number, if there is room for it and it is counted */
+static inline void
+hashids_decoder_store(hashids_decoder_t *decoder)
+{
+    if (decoder->numbers_stored < decoder->numbers_max
+            && (decoder->counting
+                || decoder->numbers_stored <= decoder->separators)) {
+        decoder->numbers[decoder->numbers_stored] = decoder->number;
+    }
+    ++decoder->numbers_stored;
+    decoder->number = 0;
+}
+
+/* an invalid character: final, unless a guard may still restart the hash */
+static inline void
+hashids_decoder_invalid(hashids_decoder_t *decoder)
+{
+    decoder->invalid = 1;
+    if (!decoder->searching) {
+        decoder->state = HASHIDS_DECODER_END;
+    }
+}
+
+/* start decoding a hash delivered in chunks */
+void
+hashids_decoder_init(hashids_decoder_t *decoder, hashids_t *hashids,
+    unsigned long long *numbers, size_t numbers_max)
+{
+    decoder->hashids = hashids;
+    decoder->numbers = numbers;
+    decoder->numbers_max = numbers ? numbers_max : 0;
+    decoder->searching = hashids->min_hash_length > 0;
+    hashids_decoder_restart(decoder);
+}
+
+/* feed the next chunk (returns 0 once the rest of the input is ignored) */
+int
+hashids_decoder_push(hashids_decoder_t *decoder, const char *data,
+    size_t length)
+{
+    hashids_t *hashids = decoder->hashids;
+    const char *end = data + length;
+    char ch, *c;
+
+    for (; data < end && decoder->state < HASHIDS_DECODER_END; ++data) {
+        ch = *data;
+
+        /* guards (and NUL) */
+        if (strchr(hashids->guards, ch)) {
+            if (decoder->searching) {
+                /* padded hashes start after the first guard: drop what
+                   the padding parsed to */
+                if (decoder->numbers_stored && decoder->numbers_max) {
+                    memset(decoder->numbers, 0, sizeof(*decoder->numbers)
+                        * (decoder->numbers_stored < decoder->numbers_max
+                            ? decoder->numbers_stored : decoder->numbers_max));
+                }
+                decoder->searching = 0;
+                hashids_decoder_restart(decoder);
+            } else if (decoder->state == HASHIDS_DECODER_NUMBER) {
+                hashids_decoder_store(decoder);
+                decoder->state = HASHIDS_DECODER_END;
+            } else if (!ch) {
+                decoder->state = HASHIDS_DECODER_EMPTY;
+            } else {
+                /* a guard lottery ends the count, not the parse */
+                decoder->counting = 0;
+                hashids_decoder_lottery(decoder, ch);
+            }
+            continue;
+        }
+
+        /* only a guard can still change the outcome */
+        if (decoder->invalid) {
+            continue;
+        }
+
+        if (strchr(hashids->separators, ch)) {
+            decoder->separators += decoder->counting;
+            if (decoder->state == HASHIDS_DECODER_LOTTERY) {
+                hashids_decoder_lottery(decoder, ch);
+            } else {
+                hashids_decoder_store(decoder);
+
+                /* resalt the alphabet */
+                hashids_salt_shuffle(hashids, decoder->alphabet,
+                    decoder->salt, decoder->p_max);
+            }
+            continue;
+        }
+
+        if (decoder->state == HASHIDS_DECODER_LOTTERY) {
+            if (strchr(hashids->alphabet, ch)) {
+                hashids_decoder_lottery(decoder, ch);
+            } else {
+                hashids_decoder_invalid(decoder);
+            }
+            continue;
+        }
+
+        if (!(c = strchr(decoder->alphabet, ch))) {
+            hashids_decoder_invalid(decoder);
+            continue;
+        }
+
+        decoder->number *= hashids->alphabet_length;
+        decoder->number += c - decoder->alphabet;
+    }
+
+    return decoder->state < HASHIDS_DECODER_END;
+}
+
+/* end of input: the numbers count, as hashids_decode_n() would return it */
+size_t
+hashids_decoder_finish(hashids_decoder_t *decoder)
+{
+    size_t numbers_count;
+
+    if (decoder->invalid) {
+        hashids_invalid_hash();
+        return 0;
+    }
+
+    /* an empty hash (the encoding of no numbers) */
+    if (decoder->state == HASHIDS_DECODER_LOTTERY
+            || decoder->state == HASHIDS_DECODER_EMPTY) {
+        return 0;
+    }
+
+    /* store last number */
+    if (decoder->state == HASHIDS_DECODER_NUMBER) {
+        hashids_decoder_store(decoder);
+        decoder->state = HASHIDS_DECODER_END;
+    }
+
+    numbers_count = decoder->separators + 1;
+    if (numbers_count > decoder->numbers_max && decoder->numbers) {
+        hashids_errno = HASHIDS_ERROR_OVERFLOW;
+    }
+
+    HASHIDS_STATS_ADD(decodes, 1);
+    return numbers_count;
+}
+
+/* character classes of the multi-salt prefilter */
+#define HASHIDS_CLASS_NONE 0
+#define HASHIDS_CLASS_ALPHABET 1
+#define HASHIDS_CLASS_SEPARATOR 2
+#define HASHIDS_CLASS_GUARD 3
+
+/* an ordered set of instances, e.g. the salts of a rotation */
+struct hashids_multi_s {
+    hashids_t **hashids;
+    size_t hashids_count;
+    unsigned char known[256];   /* bytes some instance uses */
+    unsigned char *classes;     /* 256 classes per instance */
+};
+
+/* decode with the first of several instances a hash is canonical for */
+hashids_multi_t *
+hashids_multi_init(hashids_t **hashids, size_t hashids_count)
+{
+    hashids_multi_t *multi;
+    unsigned char *classes;
+    const char *p;
+    size_t i;
+
+    multi = _hashids_alloc(sizeof(hashids_multi_t)
+        + hashids_count * (sizeof(hashids_t *) + 256));
+    if (HASHIDS_UNLIKELY(!multi)) {
+        hashids_errno = HASHIDS_ERROR_ALLOC;
+        return NULL;
+    }
+
+    multi->hashids = (hashids_t **)(multi + 1);
+    multi->hashids_count = hashids_count;
+    multi->classes = (unsigned char *)(multi->hashids + hashids_count);
+    memset(multi->known, 0, sizeof(multi->known));
+    memset(multi->classes, HASHIDS_CLASS_NONE, hashids_count * 256);
+
+    for (i = 0; i < hashids_count; ++i) {
+        multi->hashids[i] = hashids[i];
+        classes = multi->classes + i * 256;
+
+        for (p = hashids[i]->alphabet; *p; ++p) {
+            classes[(unsigned char)*p] = HASHIDS_CLASS_ALPHABET;
+        }
+        for (p = hashids[i]->separators; *p; ++p) {
+            classes[(unsigned char)*p] = HASHIDS_CLASS_SEPARATOR;
+        }
+        for (p = hashids[i]->guards; *p; ++p) {
+            classes[(unsigned char)*p] = HASHIDS_CLASS_GUARD;
+        }
+    }
+
+    for (i = 0; i < hashids_count * 256; ++i) {
+        multi->known[i % 256] |= multi->classes[i] != HASHIDS_CLASS_NONE;
+    }
+
+    return multi;
+}
+
+/* free a multi-salt decoder (not the instances) */
+void
+hashids_multi_free(hashids_multi_t *multi)
+{
+    if (multi) {
+        _hashids_free(multi);
+    }
+}
+
+/* could str be a canonical hash of this instance?  guards, separators and
+   padding must sit where hashids_encode() puts them; returns the numbers
+   count, or 0 */
+static size_t
+hashids_multi_check(hashids_t *hashids, const unsigned char *classes,
+    const char *str, size_t length)
+{
+    size_t i, begin, end, guards = 0, numbers_count = 1;
+    unsigned char class;
+
+    begin = 0;
+    end = length;
+    for (i = 0; i < length; ++i) {
+        class = classes[(unsigned char)str[i]];
+        if (class == HASHIDS_CLASS_NONE) {
+            return 0;
+        }
+        if (class == HASHIDS_CLASS_GUARD) {
+            if (++guards == 1) {
+                begin = i + 1;
+            } else {
+                end = i;
+            }
+        }
+    }
+
+    /* no guards when long enough, else one leading guard, else two around
+       the numbers with padding up to exactly min_hash_length */
+    if (guards > 2 || (guards == 0 && length < hashids->min_hash_length)
+            || (guards && length != hashids->min_hash_length)
+            || (guards == 1 && begin != 1)) {
+        return 0;
+    }
+
+    /* the padding comes from the alphabet */
+    for (i = 0; i + 1 < begin; ++i) {
+        if (classes[(unsigned char)str[i]] != HASHIDS_CLASS_ALPHABET) {
+            return 0;
+        }
+    }
+    for (i = end + (guards == 2); i < length; ++i) {
+        if (classes[(unsigned char)str[i]] != HASHIDS_CLASS_ALPHABET) {
+            return 0;
+        }
+    }
+
+    /* a lottery, then numbers of at least one digit between separators */
+    if (end - begin < 2
+            || classes[(unsigned char)str[begin]] != HASHIDS_CLASS_ALPHABET
+            || classes[(unsigned char)str[end - 1]]
+                != HASHIDS_CLASS_ALPHABET) {
+        return 0;
+    }
+    for (i = begin + 1; i < end; ++i) {
+        if (classes[(unsigned char)str[i]] == HASHIDS_CLASS_SEPARATOR) {
+            if (classes[(unsigned char)str[i - 1]]
+                    == HASHIDS_CLASS_SEPARATOR || i == begin + 1) {
+                return 0;
+            }
+            ++numbers_count;
+        }
+    }
+
+    return numbers_count;
+}
+
+/* decode (length-delimited) with the first instance str is the canonical
+   encoding for; *matched is its index */
+size_t
+hashids_multi_decode(hashids_multi_t *multi, const char *str, size_t length,
+    unsigned long long *numbers, size_t numbers_max, size_t *matched)
+{
+    hashids_t *hashids;
+    size_t i, k, numbers_count;
+    int overflow = 0, error;
+
+    /* an empty hash (the encoding of no numbers) */
+    if (!length) {
+        hashids_errno = HASHIDS_ERROR_OK;
+        return 0;
+    }
+
+    /* bytes no instance knows about reject the hash for all of them */
+    for (k = 0; k < length; ++k) {
+        if (!multi->known[(unsigned char)str[k]]) {
+            hashids_invalid_hash();
+            return 0;
+        }
+    }
+
+    for (i = 0; i < multi->hashids_count; ++i) {
+        hashids = multi->hashids[i];
+        numbers_count = hashids_multi_check(hashids, multi->classes + i * 256,
+            str, length);
+        if (!numbers_count) {
+            continue;
+        }
+        if (numbers_count > numbers_max) {
+            overflow = 1;
+            continue;
+        }
+
+        /* wrong salts mostly fail at the first separator; rejecting a
+           candidate is not an invalid hash yet */
+        if (hashids_decode_strict_at(hashids, str, length, numbers,
+                numbers_max, &error)) {
+            if (matched) {
+                *matched = i;
+            }
+            hashids_errno = HASHIDS_ERROR_OK;
+            return numbers_count;
+        }
+        if (error == HASHIDS_ERROR_ALLOC) {
+            hashids_errno = error;
+            return 0;
+        }
+        if (error == HASHIDS_ERROR_OVERFLOW) {
+            overflow = 1;
+        }
+    }
+
+    if (overflow) {
+        hashids_errno = HASHIDS_ERROR_OVERFLOW;
+    } else {
+        hashids_invalid_hash();
+    }
+    return 0;
+}
+
+/* hex digit values (-1 for non-hex characters) */
+static const signed char hashids_hex_values[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+/* encode hex */
+size_t
+hashids_encode_hex(hashids_t *hashids, char *buffer,
+    const char *hex_str)
+{
+    size_t i;
+    int value;
+    unsigned long long number;
+
+    /* a leading 1 keeps leading zeros, which leaves room for 15 digits */
+    for (i = 0, number = 1;
+            (value = hashids_hex_values[(unsigned char)hex_str[i]]) >= 0;
+            ++i) {
+        if (HASHIDS_UNLIKELY(i == 15)) {
+            hashids_errno = HASHIDS_ERROR_INVALID_NUMBER;
+            return 0;
+        }
+
+        number = (number << 4) | (unsigned)value;
+    }
+
+    return hashids_encode(hashids, buffer, 1, &number);
+}
+
+/* decode hex */
+size_t
+hashids_decode_hex(hashids_t *hashids, char *str, char *output)
+{
+    size_t result, i;
+    unsigned long long number;
+    char ch, *temp;
+
+    result = hashids_numbers_count(hashids, str);
+
+    if (result != 1) {
+        return 0;
+    }
+
+    result = hashids_decode(hashids, str, &number);
+
+    if (result != 1) {
+        return 0;
+    }
+
+    temp = output;
+
+    do {
+        ch = number % 16;
+        if (ch > 9) {
+            ch += 'A' - 10;
+        } else {
+            ch += '0';
+        }
+
+        *temp++ = (char)ch;
+
+        number /= 16;
+    } while (number);
+
+    temp--;
+    *temp = 0;
+
+    for (i = 0; i < (temp - output) / 2; ++i) {
+        ch = *(output + i);
+        *(output + i) = *(temp - 1 - i);
+        *(temp - 1 - i) = ch;
+    }
+
+    return 1;
+}
+
+/* hex digit characters */
+static const char hashids_hex_chars[16] = "0123456789ABCDEF";
+
+/* largest power of the alphabet length that does not exceed `limit` */
+static unsigned long long
+hashids_chunk_divisor(size_t alphabet_length, unsigned long long limit,
+    size_t *chunk_digits)
+{
+    unsigned long long result;
+    size_t digits;
+
+    for (result = alphabet_length, digits = 1;
+            result <= limit / alphabet_length; ++digits) {
+        result *= alphabet_length;
+    }
+
+    *chunk_digits = digits;
+    return result;
+}
+
+/* index of every alphabet character (0xFF for foreign characters) */
+static inline void
+hashids_alphabet_index(const char *alphabet, size_t alphabet_length,
+    unsigned char *index)
+{
+    size_t i;
+
+    memset(index, 0xFF, 256);
+    for (i = 0; i < alphabet_length; ++i) {
+        index[(unsigned char)alphabet[i]] = (unsigned char)i;
+    }
+}
+
+#ifdef HASHIDS_HAVE_INT128
+
+/* 128-by-64 division, `hi` must be less than `divisor` */
+static inline unsigned long long
+hashids_divmod_128_64(unsigned long long hi, unsigned long long lo,
+    unsigned long long divisor, unsigned long long *remainder)
+{
+#if defined(__x86_64__) && defined(__GNUC__)
+    unsigned long long quotient;
+
+    __asm__("divq %4"
+        : "=a" (quotient), "=d" (*remainder)
+        : "a" (lo), "d" (hi), "rm" (divisor));
+
+    return quotient;
+#else
+    unsigned __int128 n = ((unsigned __int128)hi << 64) | lo;
+
+    *remainder = (unsigned long long)(n % divisor);
+    return (unsigned long long)(n / divisor);
+#endif
+}
+
+/* write the digits of a 128-bit number, most significant first */
+static char *
+hashids_encode_digits_u128(hashids_t *hashids, const char *alphabet,
+    unsigned __int128 number, char *buffer)
+{
+    unsigned long long divisor, hi, lo, remainder;
+    size_t i, chunk_digits, alphabet_length = hashids->alphabet_length;
+    char *p = buffer;
+
+    divisor = hashids_chunk_divisor(alphabet_length, ULLONG_MAX,
+        &chunk_digits);
+
+    /* peel off whole 64-bit chunks of digits while the number is wide */
+    while (number >> 64) {
+        hi = (unsigned long long)(number >> 64);
+        lo = (unsigned long long)number;
+
+        lo = hashids_divmod_128_64(hi % divisor, lo, divisor, &remainder);
+        number = ((unsigned __int128)(hi / divisor) << 64) | lo;
+
+        for (i = 0; i < chunk_digits; ++i) {
+            *p++ = alphabet[remainder % alphabet_length];
+            remainder /= alphabet_length;
+        }
+    }
+
+    /* the rest fits in 64 bits */
+    lo = (unsigned long long)number;
+    do {
+        *p++ = alphabet[lo % alphabet_length];
+        lo /= alphabet_length;
+    } while (lo);
+
+    hashids_reverse(buffer, p);
+
+    return p;
+}
+
+/* estimate buffer size (128-bit) */
+size_t
+hashids_estimate_encoded_size_u128(hashids_t *hashids,
+    size_t numbers_count, unsigned __int128 *numbers)
+{
+    size_t i, result_len;
+    unsigned __int128 number;
+
+    for (i = 0, result_len = 1; i < numbers_count; ++i) {
+        /* digits + separator */
+        for (number = numbers[i], result_len += 2;
+                number >= hashids->alphabet_length; ++result_len) {
+            number /= hashids->alphabet_length;
+        }
+    }
+
+    if (result_len <= hashids->min_hash_length) {
+        result_len = hashids->min_hash_length + 1;
+    }
+
+    return result_len;
+}
+
+/* encode many (128-bit) */
+size_t
+hashids_encode_u128(hashids_t *hashids, char *buffer,
+    size_t numbers_count, unsigned __int128 *numbers)
+{
+    char alphabet_copy_1[HASHIDS_SCRATCH_SIZE],
+        alphabet_copy_2[HASHIDS_SCRATCH_SIZE];
+    size_t i, result_len;
+    unsigned __int128 number;
+    unsigned long long numbers_hash, started = HASHIDS_STATS_NOW();
+    int p_max;
+    char lottery, *buffer_end, *buffer_temp;
+
+    /* bail out if no numbers */
+    if (HASHIDS_UNLIKELY(!numbers_count)) {
+        if (buffer) {
+            buffer[0] = '\0';
+        }
+
+        return 0;
+    }
+
+    /* return an estimation if no buffer */
+    if (HASHIDS_UNLIKELY(!buffer)) {
+        return hashids_estimate_encoded_size_u128(hashids, numbers_count,
+            numbers);
+    }
+
+    /* copy the alphabet into internal buffer 1 */
+    memcpy(alphabet_copy_1, hashids->alphabet,
+        hashids->alphabet_length + 1);
+
+    /* walk arguments once and generate a hash */
+    for (i = 0, numbers_hash = 0; i < numbers_count; ++i) {
+        numbers_hash += (unsigned long long)(numbers[i] % (i + 100));
+    }
+
+    /* lottery character */
+    lottery = hashids->alphabet[numbers_hash % hashids->alphabet_length];
+    buffer[0] = lottery;
+    buffer_end = buffer + 1;
+
+    /* alphabet-like buffer used for salt at each iteration */
+    p_max = hashids_salt_init(hashids, alphabet_copy_2, lottery);
+
+    for (i = 0; i < numbers_count; ++i) {
+        number = numbers[i];
+
+        /* shuffle the alphabet */
+        hashids_salt_shuffle(hashids, alphabet_copy_1,
+            alphabet_copy_2, p_max);
+
+        /* hash the number */
+        buffer_temp = buffer_end;
+        buffer_end = hashids_encode_digits_u128(hashids,
+            alphabet_copy_1, number, buffer_end);
+
+        if (i + 1 < numbers_count) {
+            number %= *buffer_temp + i;
+            *buffer_end = hashids->separators[number %
+                hashids->separators_count];
+            ++buffer_end;
+        }
+    }
+
+    /* guards & padding */
+    result_len = hashids_encode_pad(hashids, buffer, buffer_end - buffer,
+        numbers_hash, alphabet_copy_1, alphabet_copy_2);
+
+    HASHIDS_STATS_CALL(encodes, encode_cycles, started);
+    return result_len;
+}
+
+/* decode (128-bit) */
+size_t
+hashids_decode_u128(hashids_t *hashids, char *str,
+    unsigned __int128 *numbers)
+{
+    char alphabet_copy_1[HASHIDS_SCRATCH_SIZE],
+        alphabet_copy_2[HASHIDS_SCRATCH_SIZE];
+    size_t numbers_count, chunk_digits, digits, n;
+    unsigned long long divisor, chunk, power, started = HASHIDS_STATS_NOW();
+    unsigned __int128 number;
+    unsigned char index[256];
+    char lottery, ch;
+    int p_max;
+
+    HASHIDS_PROBE1(decode_entry, str);
+
+    numbers_count = hashids_numbers_count(hashids, str);
+
+    if (!numbers || !numbers_count) {
+        HASHIDS_PROBE2(decode_return, numbers_count,
+            numbers_count ? HASHIDS_ERROR_OK : hashids_errno);
+        return numbers_count;
+    }
+
+    /* skip characters until we find a guard */
+    str = hashids_skip_guard(hashids, str);
+
+    /* get the lottery character */
+    lottery = *str++;
+    if (HASHIDS_UNLIKELY(!lottery)) {
+        hashids_invalid_hash();
+        HASHIDS_PROBE2(decode_return, 0, hashids_errno);
+        return 0;
+    }
+
+    /* prepare the alphabet & salt buffers */
+    memcpy(alphabet_copy_1, hashids->alphabet,
+        hashids->alphabet_length + 1);
+    p_max = hashids_salt_init(hashids, alphabet_copy_2, lottery);
+    hashids_salt_shuffle(hashids, alphabet_copy_1,
+        alphabet_copy_2, p_max);
+    hashids_alphabet_index(alphabet_copy_1,
+        hashids->alphabet_length, index);
+
+    divisor = hashids_chunk_divisor(hashids->alphabet_length, ULLONG_MAX,
+        &chunk_digits);
+
+    /* parse, accumulating up to a chunk of digits in 64 bits at a time; as
+       in hashids_decode_n(), nothing is stored past the count */
+    number = 0;
+    chunk = 0;
+    power = 1;
+    digits = 0;
+    for (n = 0;; ++str) {
+        ch = *str;
+
+        if (!ch || strchr(hashids->guards, ch)
+                || strchr(hashids->separators, ch)) {
+            /* flush the pending chunk */
+            if (digits
+                    && (__builtin_mul_overflow(number, power, &number)
+                        || __builtin_add_overflow(number, chunk, &number))) {
+                hashids_errno = HASHIDS_ERROR_OVERFLOW;
+                HASHIDS_PROBE2(decode_return, 0, hashids_errno);
+                return 0;
+            }
+
+            if (n < numbers_count) {
+                numbers[n] = number;
+            }
+            ++n;
+            if (!ch || strchr(hashids->guards, ch)) {
+                break;
+            }
+
+            number = 0;
+            chunk = 0;
+            power = 1;
+            digits = 0;
+
+            /* resalt the alphabet */
+            hashids_salt_shuffle(hashids, alphabet_copy_1,
+                alphabet_copy_2, p_max);
+            hashids_alphabet_index(alphabet_copy_1,
+                hashids->alphabet_length, index);
+
+            continue;
+        }
+
+        if (HASHIDS_UNLIKELY(digits == chunk_digits)) {
+            if (__builtin_mul_overflow(number, divisor, &number)
+                    || __builtin_add_overflow(number, chunk, &number)) {
+                hashids_errno = HASHIDS_ERROR_OVERFLOW;
+                HASHIDS_PROBE2(decode_return, 0, hashids_errno);
+                return 0;
+            }
+
+            chunk = 0;
+            power = 1;
+            digits = 0;
+        }
+
+        if (HASHIDS_UNLIKELY(index[(unsigned char)ch] == 0xFF)) {
+            hashids_invalid_hash();
+            HASHIDS_PROBE2(decode_return, 0, hashids_errno);
+            return 0;
+        }
+
+        chunk = chunk * hashids->alphabet_length + index[(unsigned char)ch];
+        power *= hashids->alphabet_length;
+        ++digits;
+    }
+
+    HASHIDS_STATS_CALL(decodes, decode_cycles, started);
+    HASHIDS_PROBE2(decode_return, numbers_count, HASHIDS_ERROR_OK);
+    return numbers_count;
+}
+
+/* encode hex (128-bit) */
+size_t
+hashids_encode_hex_u128(hashids_t *hashids, char *buffer,
+    const char *hex_str)
+{
+    unsigned __int128 number;
+    size_t i;
+    int value;
+
+    for (i = 0, number = 0; hex_str[i]; ++i) {
+        value = hashids_hex_values[(unsigned char)hex_str[i]];
+
+        if (HASHIDS_UNLIKELY(value < 0 || i == 32)) {
+            hashids_errno = HASHIDS_ERROR_INVALID_NUMBER;
+            return 0;
+        }
+
+        number = (number << 4) | (unsigned)value;
+    }
+
+    if (HASHIDS_UNLIKELY(!i)) {
+        hashids_errno = HASHIDS_ERROR_INVALID_NUMBER;
+        return 0;
+    }
+
+    return hashids_encode_u128(hashids, buffer, 1, &number);
+}
+
+/* decode hex (128-bit) */
+size_t
+hashids_decode_hex_u128(hashids_t *hashids, char *str, char *output)
+{
+    unsigned __int128 number;
+    char *temp;
+
+    if (hashids_numbers_count(hashids, str) != 1
+            || hashids_decode_u128(hashids, str, &number) != 1) {
+        return 0;
+    }
+
+    temp = output;
+    do {
+        *temp++ = hashids_hex_chars[(unsigned)number & 0xF];
+        number >>= 4;
+    } while (number);
+    *temp = '\0';
+
+    hashids_reverse(output, temp);
+
+    return 1;
+}
+
+#endif
+
+/* limbs used for arbitrary precision (byte string) numbers */
+#ifdef HASHIDS_HAVE_INT128
+typedef unsigned long long hashids_limb_t;
+typedef unsigned __int128 hashids_dlimb_t;
+#   define HASHIDS_LIMB_MAX ULLONG_MAX
+#else
+typedef unsigned int hashids_limb_t;
+typedef unsigned long long hashids_dlimb_t;
+#   define HASHIDS_LIMB_MAX UINT_MAX
+#endif
+#define HASHIDS_LIMB_BITS (sizeof(hashids_limb_t) * 8)
+
+/* limbs kept on the stack (512 bytes of input) before we allocate */
+#define HASHIDS_STACK_LIMBS 64
+
+/* double-limb by limb division, `hi` must be less than `divisor` */
+static inline hashids_limb_t
+hashids_limb_divmod(hashids_limb_t hi, hashids_limb_t lo,
+    hashids_limb_t divisor, hashids_limb_t *remainder)
+{
+#ifdef HASHIDS_HAVE_INT128
+    return hashids_divmod_128_64(hi, lo, divisor, remainder);
+#else
+    hashids_dlimb_t n = ((hashids_dlimb_t)hi << HASHIDS_LIMB_BITS) | lo;
+
+    *remainder = (hashids_limb_t)(n % divisor);
+    return (hashids_limb_t)(n / divisor);
+#endif
+}
+
+/* divide a limb number in place, returns the remainder */
+static hashids_limb_t
+hashids_limbs_divmod(hashids_limb_t *limbs, size_t *limbs_count,
+    hashids_limb_t divisor)
+{
+    hashids_limb_t remainder = 0;
+    size_t i;
+
+    for (i = *limbs_count; i-- > 0; /* empty */) {
+        limbs[i] = hashids_limb_divmod(remainder, limbs[i], divisor,
+            &remainder);
+    }
+
+    /* drop leading zero limbs */
+    while (*limbs_count && !limbs[*limbs_count - 1]) {
+        --*limbs_count;
+    }
+
+    return remainder;
+}
+
+/* limb number remainder, leaves the number intact */
+static hashids_limb_t
+hashids_limbs_mod(const hashids_limb_t *limbs, size_t limbs_count,
+    hashids_limb_t divisor)
+{
+    hashids_limb_t remainder = 0;
+    size_t i;
+
+    for (i = limbs_count; i-- > 0; /* empty */) {
+        hashids_limb_divmod(remainder, limbs[i], divisor, &remainder);
+    }
+
+    return remainder;
+}
+
+/* limbs = limbs * multiplier + addend, returns 0 on overflow */
+static int
+hashids_limbs_muladd(hashids_limb_t *limbs, size_t *limbs_count,
+    size_t limbs_capacity, hashids_limb_t multiplier, hashids_limb_t addend)
+{
+    hashids_limb_t carry = addend;
+    hashids_dlimb_t product;
+    size_t i;
+
+    for (i = 0; i < *limbs_count; ++i) {
+        product = (hashids_dlimb_t)limbs[i] * multiplier + carry;
+        limbs[i] = (hashids_limb_t)product;
+        carry = (hashids_limb_t)(product >> HASHIDS_LIMB_BITS);
+    }
+
+    if (carry) {
+        if (HASHIDS_UNLIKELY(*limbs_count == limbs_capacity)) {
+            return 0;
+        }
+
+        limbs[(*limbs_count)++] = carry;
+    }
+
+    return 1;
+}
+
+/* estimate buffer size (byte string) */
+size_t
+hashids_estimate_encoded_size_bytes(hashids_t *hashids, size_t bytes_length)
+{
+    size_t result_len;
+
+    /* lottery + digits of (1 << 8 * bytes_length) + rounding + terminator */
+    result_len = 3 + (size_t)ceil((double)(bytes_length + 1) * 8
+        / log2(hashids->alphabet_length));
+
+    if (result_len <= hashids->min_hash_length) {
+        result_len = hashids->min_hash_length + 1;
+    }
+
+    return result_len;
+}
+
+/* encode a byte string */
+size_t
+hashids_encode_bytes(hashids_t *hashids, char *buffer,
+    const unsigned char *bytes, size_t bytes_length)
+{
+    char alphabet_copy_1[HASHIDS_SCRATCH_SIZE],
+        alphabet_copy_2[HASHIDS_SCRATCH_SIZE];
+    hashids_limb_t limbs_stack[HASHIDS_STACK_LIMBS], *limbs, divisor, chunk;
+    size_t i, limbs_count, chunk_digits, result_len;
+    unsigned long long numbers_hash, started = HASHIDS_STATS_NOW();
+    char lottery, *buffer_end;
+    int p_max;
+
+    /* return an estimation if no buffer */
+    if (HASHIDS_UNLIKELY(!buffer)) {
+        return hashids_estimate_encoded_size_bytes(hashids, bytes_length);
+    }
+
+    /* a leading 0x01 byte keeps leading zeros (and the length) intact */
+    limbs_count = (bytes_length + sizeof(hashids_limb_t))
+        / sizeof(hashids_limb_t);
+    if (limbs_count <= HASHIDS_STACK_LIMBS) {
+        limbs = limbs_stack;
+    } else {
+        limbs = _hashids_alloc(limbs_count * sizeof(hashids_limb_t));
+        if (HASHIDS_UNLIKELY(!limbs)) {
+            hashids_errno = HASHIDS_ERROR_ALLOC;
+            return 0;
+        }
+    }
+
+    /* load big-endian bytes into little-endian limbs */
+    memset(limbs, 0, limbs_count * sizeof(hashids_limb_t));
+    for (i = 0; i < bytes_length; ++i) {
+        limbs[i / sizeof(hashids_limb_t)] |= (hashids_limb_t)
+            bytes[bytes_length - 1 - i] << (i % sizeof(hashids_limb_t) * 8);
+    }
+    limbs[i / sizeof(hashids_limb_t)] |=
+        (hashids_limb_t)1 << (i % sizeof(hashids_limb_t) * 8);
+
+    /* single number: the lottery is the number itself modulo 100 */
+    numbers_hash = hashids_limbs_mod(limbs, limbs_count, 100);
+    lottery = hashids->alphabet[numbers_hash % hashids->alphabet_length];
+    buffer[0] = lottery;
+
+    /* shuffle the alphabet */
+    memcpy(alphabet_copy_1, hashids->alphabet,
+        hashids->alphabet_length + 1);
+    p_max = hashids_salt_init(hashids, alphabet_copy_2, lottery);
+    hashids_salt_shuffle(hashids, alphabet_copy_1,
+        alphabet_copy_2, p_max);
+
+    /* peel off a limb's worth of digits per division */
+    divisor = (hashids_limb_t)hashids_chunk_divisor(hashids->alphabet_length,
+        HASHIDS_LIMB_MAX, &chunk_digits);
+    buffer_end = buffer + 1;
+    while (limbs_count > 1) {
+        chunk = hashids_limbs_divmod(limbs, &limbs_count, divisor);
+        for (i = 0; i < chunk_digits; ++i) {
+            *buffer_end++ = alphabet_copy_1[chunk
+                % hashids->alphabet_length];
+            chunk /= hashids->alphabet_length;
+        }
+    }
+
+    /* the last limb is never zero, thanks to the leading 0x01 */
+    for (chunk = limbs[0]; chunk; chunk /= hashids->alphabet_length) {
+        *buffer_end++ = alphabet_copy_1[chunk
+            % hashids->alphabet_length];
+    }
+
+    hashids_reverse(buffer + 1, buffer_end);
+
+    if (limbs != limbs_stack) {
+        _hashids_free(limbs);
+    }
+
+    /* guards & padding */
+    result_len = hashids_encode_pad(hashids, buffer, buffer_end - buffer,
+        numbers_hash, alphabet_copy_1, alphabet_copy_2);
+
+    HASHIDS_STATS_CALL(encodes, encode_cycles, started);
+    return result_len;
+}
+
+/* decode a byte string, returns the number of bytes written */
+size_t
+hashids_decode_bytes(hashids_t *hashids, char *str,
+    unsigned char *output, size_t output_size)
+{
+    char alphabet_copy_1[HASHIDS_SCRATCH_SIZE],
+        alphabet_copy_2[HASHIDS_SCRATCH_SIZE];
+    hashids_limb_t limbs_stack[HASHIDS_STACK_LIMBS], *limbs, divisor, chunk,
+        power;
+    size_t i, limbs_count, limbs_capacity, chunk_digits, digits, bytes_length,
+        numbers_count;
+    unsigned long long started = HASHIDS_STATS_NOW();
+    unsigned char index[256];
+    char lottery, ch;
+    int p_max;
+
+    numbers_count = hashids_numbers_count(hashids, str);
+    if (numbers_count != 1) {
+        if (numbers_count) {
+            hashids_invalid_hash();
+        }
+        return 0;
+    }
+
+    /* skip characters until we find a guard */
+    str = hashids_skip_guard(hashids, str);
+
+    /* get the lottery character */
+    lottery = *str++;
+    if (HASHIDS_UNLIKELY(!lottery)) {
+        hashids_invalid_hash();
+        return 0;
+    }
+
+    /* room for the output and the leading 0x01 */
+    limbs_capacity = (output_size + sizeof(hashids_limb_t))
+        / sizeof(hashids_limb_t);
+    if (limbs_capacity <= HASHIDS_STACK_LIMBS) {
+        limbs = limbs_stack;
+    } else {
+        limbs = _hashids_alloc(limbs_capacity * sizeof(hashids_limb_t));
+        if (HASHIDS_UNLIKELY(!limbs)) {
+            hashids_errno = HASHIDS_ERROR_ALLOC;
+            return 0;
+        }
+    }
+
+    /* shuffle the alphabet */
+    memcpy(alphabet_copy_1, hashids->alphabet,
+        hashids->alphabet_length + 1);
+    p_max = hashids_salt_init(hashids, alphabet_copy_2, lottery);
+    hashids_salt_shuffle(hashids, alphabet_copy_1,
+        alphabet_copy_2, p_max);
+    hashids_alphabet_index(alphabet_copy_1,
+        hashids->alphabet_length, index);
+
+    /* accumulate a limb's worth of digits per multiplication */
+    divisor = (hashids_limb_t)hashids_chunk_divisor(hashids->alphabet_length,
+        HASHIDS_LIMB_MAX, &chunk_digits);
+    limbs_count = 0;
+    chunk = 0;
+    power = 1;
+    digits = 0;
+    for (;; ++str) {
+        ch = *str;
+
+        if (!ch || strchr(hashids->guards, ch) || digits == chunk_digits) {
+            if (!hashids_limbs_muladd(limbs, &limbs_count, limbs_capacity,
+                    digits == chunk_digits ? divisor : power, chunk)) {
+                hashids_errno = HASHIDS_ERROR_OVERFLOW;
+                bytes_length = 0;
+                goto cleanup;
+            }
+
+            if (!ch || strchr(hashids->guards, ch)) {
+                break;
+            }
+
+            chunk = 0;
+            power = 1;
+            digits = 0;
+        }
+
+        if (HASHIDS_UNLIKELY(index[(unsigned char)ch] == 0xFF)) {
+            hashids_invalid_hash();
+            bytes_length = 0;
+            goto cleanup;
+        }
+
+        chunk = chunk * hashids->alphabet_length + index[(unsigned char)ch];
+        power *= hashids->alphabet_length;
+        ++digits;
+    }
+
+    /* the most significant byte must be our 0x01 marker */
+    for (i = limbs_count * sizeof(hashids_limb_t); i-- > 0; /* empty */) {
+        ch = (char)(limbs[i / sizeof(hashids_limb_t)]
+            >> (i % sizeof(hashids_limb_t) * 8));
+        if (ch) {
+            break;
+        }
+    }
+    if (HASHIDS_UNLIKELY(ch != 1 || i == (size_t)-1)) {
+        hashids_invalid_hash();
+        bytes_length = 0;
+        goto cleanup;
+    }
+
+    /* unload the limbs, big-endian */
+    bytes_length = i;
+    if (HASHIDS_UNLIKELY(bytes_length > output_size)) {
+        hashids_errno = HASHIDS_ERROR_OVERFLOW;
+        bytes_length = 0;
+        goto cleanup;
+    }
+    for (i = 0; i < bytes_length; ++i) {
+        output[bytes_length - 1 - i] = (unsigned char)(limbs[i
+            / sizeof(hashids_limb_t)] >> (i % sizeof(hashids_limb_t) * 8));
+    }
+
+    HASHIDS_STATS_CALL(decodes, decode_cycles, started);
+
+cleanup:
+    if (limbs != limbs_stack) {
+        _hashids_free(limbs);
+    }
+
+    return bytes_length;
+}
+
+/* hex digits per number in chunked hex mode */
+#define HASHIDS_HEX_CHUNK_LENGTH 12
+
+/* lowercase hex digit characters (as other ports output them) */
+static const char hashids_hex_chars_lower[16] = "0123456789abcdef";
+
+/* hex chunk with a leading 1 (the hex string must be validated) */
+static inline unsigned long long
+hashids_hex_chunk(const char *hex_str, size_t length)
+{
+    unsigned long long number;
+    size_t i;
+
+    for (i = 0, number = 1; i < length; ++i) {
+        number = (number << 4)
+            | (unsigned)hashids_hex_values[(unsigned char)hex_str[i]];
+    }
+
+    return number;
+}
+
+/* estimate buffer size (chunked hex) */
+size_t
+hashids_estimate_encoded_size_hex(hashids_t *hashids, size_t hex_length)
+{
+    unsigned long long number;
+    size_t digits, result_len;
+
+    /* every chunk is less than 16 ** 13 */
+    for (number = (1ull << (4 * (HASHIDS_HEX_CHUNK_LENGTH + 1))) - 1,
+            digits = 1; number >= hashids->alphabet_length; ++digits) {
+        number /= hashids->alphabet_length;
+    }
+
+    /* lottery + (digits + separator) per chunk, the last one's is the NUL */
+    result_len = 1 + (hex_length + HASHIDS_HEX_CHUNK_LENGTH - 1)
+        / HASHIDS_HEX_CHUNK_LENGTH * (digits + 1);
+
+    if (result_len <= hashids->min_hash_length) {
+        result_len = hashids->min_hash_length + 1;
+    }
+
+    return result_len;
+}
+
+/* encode hex (chunked, compatible with other ports) */
+size_t
+hashids_encode_hex_chunked(hashids_t *hashids, char *buffer,
+    size_t buffer_size, const char *hex_str)
+{
+    char alphabet_copy_1[HASHIDS_SCRATCH_SIZE],
+        alphabet_copy_2[HASHIDS_SCRATCH_SIZE];
+    size_t i, hex_length, numbers_count, chunk_length, result_len;
+    unsigned long long number, numbers_hash, started = HASHIDS_STATS_NOW();
+    int p_max;
+    char lottery, *buffer_end, *buffer_temp;
+
+    /* validate */
+    for (hex_length = 0; hex_str[hex_length]; ++hex_length) {
+        if (HASHIDS_UNLIKELY(
+                hashids_hex_values[(unsigned char)hex_str[hex_length]] < 0)) {
+            hashids_errno = HASHIDS_ERROR_INVALID_NUMBER;
+            return 0;
+        }
+    }
+    if (HASHIDS_UNLIKELY(!hex_length)) {
+        hashids_errno = HASHIDS_ERROR_INVALID_NUMBER;
+        return 0;
+    }
+    if (HASHIDS_UNLIKELY(buffer_size
+            < hashids_estimate_encoded_size_hex(hashids, hex_length))) {
+        hashids_errno = HASHIDS_ERROR_OVERFLOW;
+        return 0;
+    }
+
+    numbers_count = (hex_length + HASHIDS_HEX_CHUNK_LENGTH - 1)
+        / HASHIDS_HEX_CHUNK_LENGTH;
+
+    /* walk chunks once and generate a hash */
+    for (i = 0, numbers_hash = 0; i < numbers_count; ++i) {
+        chunk_length = hex_length - i * HASHIDS_HEX_CHUNK_LENGTH;
+        if (chunk_length > HASHIDS_HEX_CHUNK_LENGTH) {
+            chunk_length = HASHIDS_HEX_CHUNK_LENGTH;
+        }
+
+        number = hashids_hex_chunk(hex_str + i * HASHIDS_HEX_CHUNK_LENGTH,
+            chunk_length);
+        numbers_hash += number % (i + 100);
+    }
+
+    /* lottery character */
+    lottery = hashids->alphabet[numbers_hash % hashids->alphabet_length];
+    buffer[0] = lottery;
+    buffer_end = buffer + 1;
+
+    /* alphabet-like buffer used for salt at each iteration */
+    memcpy(alphabet_copy_1, hashids->alphabet,
+        hashids->alphabet_length + 1);
+    p_max = hashids_salt_init(hashids, alphabet_copy_2, lottery);
+
+    /* walk chunks again and encode them */
+    for (i = 0; i < numbers_count; ++i) {
+        chunk_length = hex_length - i * HASHIDS_HEX_CHUNK_LENGTH;
+        if (chunk_length > HASHIDS_HEX_CHUNK_LENGTH) {
+            chunk_length = HASHIDS_HEX_CHUNK_LENGTH;
+        }
+
+        number = hashids_hex_chunk(hex_str + i * HASHIDS_HEX_CHUNK_LENGTH,
+            chunk_length);
+
+        /* shuffle the alphabet */
+        hashids_salt_shuffle(hashids, alphabet_copy_1,
+            alphabet_copy_2, p_max);
+
+        /* hash the number */
+        buffer_temp = buffer_end;
+        buffer_end = hashids_encode_digits(hashids, alphabet_copy_1,
+            number, buffer_end);
+
+        if (i + 1 < numbers_count) {
+            number %= *buffer_temp + i;
+            *buffer_end = hashids->separators[number %
+                hashids->separators_count];
+            ++buffer_end;
+        }
+    }
+
+    /* guards & padding */
+    result_len = hashids_encode_pad(hashids, buffer, buffer_end - buffer,
+        numbers_hash, alphabet_copy_1, alphabet_copy_2);
+
+    HASHIDS_STATS_CALL(encodes, encode_cycles, started);
+    return result_len;
+}
+
+/* decode hex (chunked, compatible with other ports) */
+size_t
+hashids_decode_hex_chunked(hashids_t *hashids, char *str, char *output,
+    size_t output_size)
+{
+    char alphabet_copy_1[HASHIDS_SCRATCH_SIZE],
+        alphabet_copy_2[HASHIDS_SCRATCH_SIZE];
+    size_t nibbles, output_length;
+    unsigned long long number, started = HASHIDS_STATS_NOW();
+    unsigned char index[256];
+    char lottery, ch;
+    int p_max;
+
+    if (!hashids_numbers_count(hashids, str)) {
+        return 0;
+    }
+
+    /* skip characters until we find a guard */
+    str = hashids_skip_guard(hashids, str);
+
+    /* get the lottery character */
+    lottery = *str++;
+    if (HASHIDS_UNLIKELY(!lottery)) {
+        hashids_invalid_hash();
+        return 0;
+    }
+
+    /* prepare the alphabet & salt buffers */
+    memcpy(alphabet_copy_1, hashids->alphabet,
+        hashids->alphabet_length + 1);
+    p_max = hashids_salt_init(hashids, alphabet_copy_2, lottery);
+    hashids_salt_shuffle(hashids, alphabet_copy_1,
+        alphabet_copy_2, p_max);
+    hashids_alphabet_index(alphabet_copy_1,
+        hashids->alphabet_length, index);
+
+    /* parse */
+    number = 0;
+    output_length = 0;
+    for (;; ++str) {
+        ch = *str;
+
+        if (!ch || strchr(hashids->guards, ch)
+                || strchr(hashids->separators, ch)) {
+            /* every chunk has a leading 1 nibble */
+            for (nibbles = 1; nibbles < 16 && number >> (4 * nibbles);
+                    ++nibbles) {
+                /* empty */
+            }
+            if (HASHIDS_UNLIKELY(number >> (4 * (nibbles - 1)) != 1)) {
+                hashids_invalid_hash();
+                return 0;
+            }
+            if (HASHIDS_UNLIKELY(output_length + nibbles > output_size)) {
+                hashids_errno = HASHIDS_ERROR_OVERFLOW;
+                return 0;
+            }
+
+            /* write the chunk sans the leading 1 */
+            while (--nibbles) {
+                output[output_length++] =
+                    hashids_hex_chars_lower[(number >> (4 * (nibbles - 1)))
+                        & 0xF];
+            }
+
+            if (!ch || strchr(hashids->guards, ch)) {
+                break;
+            }
+
+            number = 0;
+
+            /* resalt the alphabet */
+            hashids_salt_shuffle(hashids, alphabet_copy_1,
+                alphabet_copy_2, p_max);
+            hashids_alphabet_index(alphabet_copy_1,
+                hashids->alphabet_length, index);
+
+            continue;
+        }
+
+        if (HASHIDS_UNLIKELY(index[(unsigned char)ch] == 0xFF
+                || number > (ULLONG_MAX - index[(unsigned char)ch])
+                    / hashids->alphabet_length)) {
+            hashids_invalid_hash();
+            return 0;
+        }
+
+        number = number * hashids->alphabet_length + index[(unsigned char)ch];
+    }
+
+    output[output_length] = '\0';
+
+    HASHIDS_STATS_CALL(decodes, decode_cycles, started);
+    return output_length;
 }
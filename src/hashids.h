@@ -37,19 +37,61 @@
 #define HASHIDS_ERROR_ALPHABET_SPACE -3
 #define HASHIDS_ERROR_INVALID_HASH -4
 #define HASHIDS_ERROR_INVALID_NUMBER -5
+#define HASHIDS_ERROR_OVERFLOW -6
 
-/* exported hashids_errno */
-extern int hashids_errno;
+/* per-call scratch: alphabets hold at most 255 distinct bytes, plus NUL */
+#define HASHIDS_SCRATCH_SIZE 256
+
+/* native 128-bit integers */
+#if defined(__SIZEOF_INT128__)
+#   define HASHIDS_HAVE_INT128 1
+#endif
+
+/* thread-local where the compiler supports it */
+#if defined(__GNUC__)
+#   define HASHIDS_THREAD_LOCAL __thread
+#elif defined(__cplusplus) && __cplusplus >= 201103L
+#   define HASHIDS_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#   define HASHIDS_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#   define HASHIDS_THREAD_LOCAL __declspec(thread)
+#endif
+#if defined(HASHIDS_THREAD_LOCAL)
+#   define HASHIDS_HAVE_THREAD_LOCAL 1
+#else
+#   define HASHIDS_THREAD_LOCAL
+#endif
+
+/* linkage: single-header mode (HASHIDS_IMPLEMENTATION before including
+   hashids_single.h) makes the whole library static to the including
+   translation unit, so encode and decode can be inlined into callers */
+#if defined(HASHIDS_SINGLE_HEADER) && defined(HASHIDS_IMPLEMENTATION)
+#   define HASHIDS_API static inline
+#   define HASHIDS_EXTERN static
+#   define HASHIDS_STORAGE static
+#else
+#   define HASHIDS_API
+#   define HASHIDS_EXTERN extern
+#   define HASHIDS_STORAGE
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* exported hashids_errno (per thread) */
+HASHIDS_EXTERN HASHIDS_THREAD_LOCAL int hashids_errno;
 
 /* alloc / free */
-extern void *(*_hashids_alloc)(size_t size);
-extern void (*_hashids_free)(void *ptr);
+HASHIDS_EXTERN void *(*_hashids_alloc)(size_t size);
+HASHIDS_EXTERN void (*_hashids_free)(void *ptr);
 
 /* the hashids "object" */
 struct hashids_s {
     char *alphabet;
-    char *alphabet_copy_1;
-    char *alphabet_copy_2;
+    char *alphabet_copy_1;      /* unused, always NULL */
+    char *alphabet_copy_2;      /* unused, always NULL */
     size_t alphabet_length;
 
     char *salt;
@@ -62,58 +104,201 @@ struct hashids_s {
     size_t guards_count;
 
     size_t min_hash_length;
+
+    struct hashids_cache_s *cache;  /* optional, see hashids_cache_enable */
 };
 typedef struct hashids_s hashids_t;
 
+/* instrumentation counters (compiled in with --enable-stats) */
+struct hashids_stats_s {
+    unsigned long long encodes;
+    unsigned long long decodes;
+    unsigned long long shuffles;
+    unsigned long long padding_iterations;
+    unsigned long long invalid_hashes;
+    unsigned long long encode_cycles;
+    unsigned long long decode_cycles;
+    unsigned long long cache_hits;
+    unsigned long long cache_misses;
+};
+typedef struct hashids_stats_s hashids_stats_t;
+
+/* incremental decoder state (see hashids_decoder_push) */
+struct hashids_decoder_s {
+    hashids_t *hashids;
+    unsigned long long *numbers;
+    size_t numbers_max;
+    size_t numbers_stored;
+    size_t separators;          /* separators counted before the end */
+    unsigned long long number;  /* the number being parsed */
+    int state;
+    int searching;              /* no guard seen yet, min_hash_length > 0 */
+    int counting;               /* the end of the hash not reached yet */
+    int invalid;
+    int p_max;
+    char alphabet[HASHIDS_SCRATCH_SIZE];
+    char salt[HASHIDS_SCRATCH_SIZE];
+};
+typedef struct hashids_decoder_s hashids_decoder_t;
+
+/* iterator over the hashes of consecutive numbers (opaque) */
+typedef struct hashids_range_s hashids_range_t;
+
+/* decoder trying several instances in order (opaque) */
+typedef struct hashids_multi_s hashids_multi_t;
+
 /* exported function definitions */
-void
+HASHIDS_API int
+hashids_stats(hashids_stats_t *stats);
+
+HASHIDS_API void
+hashids_stats_reset(void);
+
+HASHIDS_API void
 hashids_shuffle(char *str, size_t str_length, char *salt, size_t salt_length);
 
-void
+HASHIDS_API void
 hashids_free(hashids_t *hashids);
 
-hashids_t *
+HASHIDS_API int
+hashids_cache_enable(hashids_t *hashids, size_t entries,
+    size_t max_numbers);
+
+HASHIDS_API hashids_t *
 hashids_init3(const char *salt, size_t min_hash_length,
     const char *alphabet);
 
-hashids_t *
+HASHIDS_API hashids_t *
 hashids_init2(const char *salt, size_t min_hash_length);
 
-hashids_t *
+HASHIDS_API hashids_t *
 hashids_init(const char *salt);
 
-size_t
+HASHIDS_API size_t
 hashids_estimate_encoded_size(hashids_t *hashids,
     size_t numbers_count, unsigned long long *numbers);
 
-size_t
+HASHIDS_API size_t
 hashids_estimate_encoded_size_v(hashids_t *hashids,
     size_t numbers_count, ...);
 
-size_t
+HASHIDS_API size_t
 hashids_encode(hashids_t *hashids, char *buffer,
     size_t numbers_count, unsigned long long *numbers);
 
-size_t
+HASHIDS_API size_t
 hashids_encode_v(hashids_t *hashids, char *buffer,
     size_t numbers_count, ...);
 
-size_t
+HASHIDS_API size_t
 hashids_encode_one(hashids_t *hashids, char *buffer,
     unsigned long long number);
 
-size_t
+HASHIDS_API hashids_range_t *
+hashids_range_init(hashids_t *hashids, unsigned long long start,
+    unsigned long long end);
+
+HASHIDS_API size_t
+hashids_range_next(hashids_range_t *range, char *buffer);
+
+HASHIDS_API void
+hashids_range_free(hashids_range_t *range);
+
+HASHIDS_API size_t
 hashids_numbers_count(hashids_t *hashids, char *str);
 
-size_t
+HASHIDS_API size_t
 hashids_decode(hashids_t *hashids, char *str,
     unsigned long long *numbers);
 
-size_t
+HASHIDS_API size_t
+hashids_numbers_count_n(hashids_t *hashids, const char *str, size_t length);
+
+HASHIDS_API size_t
+hashids_decode_n(hashids_t *hashids, const char *str, size_t length,
+    unsigned long long *numbers);
+
+HASHIDS_API size_t
+hashids_decode_strict(hashids_t *hashids, const char *str,
+    unsigned long long *numbers, size_t numbers_max);
+
+HASHIDS_API size_t
+hashids_decode_strict_n(hashids_t *hashids, const char *str, size_t length,
+    unsigned long long *numbers, size_t numbers_max);
+
+HASHIDS_API void
+hashids_decoder_init(hashids_decoder_t *decoder, hashids_t *hashids,
+    unsigned long long *numbers, size_t numbers_max);
+
+HASHIDS_API int
+hashids_decoder_push(hashids_decoder_t *decoder, const char *data,
+    size_t length);
+
+HASHIDS_API size_t
+hashids_decoder_finish(hashids_decoder_t *decoder);
+
+HASHIDS_API hashids_multi_t *
+hashids_multi_init(hashids_t **hashids, size_t hashids_count);
+
+HASHIDS_API size_t
+hashids_multi_decode(hashids_multi_t *multi, const char *str, size_t length,
+    unsigned long long *numbers, size_t numbers_max, size_t *matched);
+
+HASHIDS_API void
+hashids_multi_free(hashids_multi_t *multi);
+
+HASHIDS_API size_t
 hashids_encode_hex(hashids_t *hashids, char *buffer,
     const char *hex_str);
 
-size_t
+HASHIDS_API size_t
 hashids_decode_hex(hashids_t *hashids, char *str, char *output);
 
+HASHIDS_API size_t
+hashids_estimate_encoded_size_hex(hashids_t *hashids, size_t hex_length);
+
+HASHIDS_API size_t
+hashids_encode_hex_chunked(hashids_t *hashids, char *buffer,
+    size_t buffer_size, const char *hex_str);
+
+HASHIDS_API size_t
+hashids_decode_hex_chunked(hashids_t *hashids, char *str, char *output,
+    size_t output_size);
+
+HASHIDS_API size_t
+hashids_estimate_encoded_size_bytes(hashids_t *hashids, size_t bytes_length);
+
+HASHIDS_API size_t
+hashids_encode_bytes(hashids_t *hashids, char *buffer,
+    const unsigned char *bytes, size_t bytes_length);
+
+HASHIDS_API size_t
+hashids_decode_bytes(hashids_t *hashids, char *str,
+    unsigned char *output, size_t output_size);
+
+#ifdef HASHIDS_HAVE_INT128
+HASHIDS_API size_t
+hashids_estimate_encoded_size_u128(hashids_t *hashids,
+    size_t numbers_count, unsigned __int128 *numbers);
+
+HASHIDS_API size_t
+hashids_encode_u128(hashids_t *hashids, char *buffer,
+    size_t numbers_count, unsigned __int128 *numbers);
+
+HASHIDS_API size_t
+hashids_decode_u128(hashids_t *hashids, char *str,
+    unsigned __int128 *numbers);
+
+HASHIDS_API size_t
+hashids_encode_hex_u128(hashids_t *hashids, char *buffer,
+    const char *hex_str);
+
+HASHIDS_API size_t
+hashids_decode_hex_u128(hashids_t *hashids, char *str, char *output);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
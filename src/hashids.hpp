@@ -0,0 +1,948 @@
+#ifndef HASHIDS_HPP
+#define HASHIDS_HPP 1
+
+/* header-only C++17 wrapper; std::span overloads and static_encoder with
+   C++20 */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 202002L
+#   include <span>
+#endif
+
+#include "hashids.h"
+
+namespace hashids {
+
+/* HASHIDS_ERROR_* as an error code enum */
+enum class errc : int {
+    ok = HASHIDS_ERROR_OK,
+    alloc = HASHIDS_ERROR_ALLOC,
+    alphabet_length = HASHIDS_ERROR_ALPHABET_LENGTH,
+    alphabet_space = HASHIDS_ERROR_ALPHABET_SPACE,
+    invalid_hash = HASHIDS_ERROR_INVALID_HASH,
+    invalid_number = HASHIDS_ERROR_INVALID_NUMBER,
+    overflow = HASHIDS_ERROR_OVERFLOW
+};
+
+inline const std::error_category &
+category() noexcept
+{
+    struct category_t : std::error_category {
+        const char *
+        name() const noexcept override
+        {
+            return "hashids";
+        }
+
+        std::string
+        message(int code) const override
+        {
+            switch (static_cast<errc>(code)) {
+                case errc::ok:
+                    return "success";
+                case errc::alloc:
+                    return "allocation failed";
+                case errc::alphabet_length:
+                    return "alphabet is too short";
+                case errc::alphabet_space:
+                    return "alphabet contains whitespace characters";
+                case errc::invalid_hash:
+                    return "invalid hash";
+                case errc::invalid_number:
+                    return "invalid number";
+                case errc::overflow:
+                    return "output buffer too small";
+            }
+
+            return "unknown error";
+        }
+    };
+    static const category_t instance;
+
+    return instance;
+}
+
+inline std::error_code
+make_error_code(errc error) noexcept
+{
+    return std::error_code(static_cast<int>(error), category());
+}
+
+} /* namespace hashids */
+
+template <>
+struct std::is_error_code_enum<hashids::errc> : std::true_type {};
+
+namespace hashids {
+
+/* outcome of a noexcept call: a size (characters or numbers) and an error;
+   on errc::overflow the size is what the output needs */
+struct result {
+    std::size_t size;
+    errc error;
+
+    explicit operator bool() const noexcept
+    {
+        return error == errc::ok;
+    }
+};
+
+/* an initialized instance; encoding and decoding only read it, so one
+   encoder can be shared across threads */
+class encoder {
+public:
+    /* hashes up to this size are built on the stack */
+    static constexpr std::size_t stack_size = 256;
+
+    explicit encoder(std::string_view salt = HASHIDS_DEFAULT_SALT,
+        std::size_t min_hash_length = HASHIDS_DEFAULT_MIN_HASH_LENGTH,
+        std::string_view alphabet = HASHIDS_DEFAULT_ALPHABET)
+    {
+        const std::string salt_z(salt), alphabet_z(alphabet);
+
+        hashids_ = hashids_init3(salt_z.c_str(), min_hash_length,
+            alphabet_z.c_str());
+        if (!hashids_) {
+            throw std::system_error(static_cast<errc>(hashids_errno));
+        }
+    }
+
+    encoder(const encoder &) = delete;
+    encoder &operator=(const encoder &) = delete;
+
+    encoder(encoder &&other) noexcept
+        : hashids_(std::exchange(other.hashids_, nullptr))
+    {
+    }
+
+    encoder &
+    operator=(encoder &&other) noexcept
+    {
+        std::swap(hashids_, other.hashids_);
+        return *this;
+    }
+
+    ~encoder()
+    {
+        if (hashids_) {
+            hashids_free(hashids_);
+        }
+    }
+
+    /* the underlying C instance */
+    const hashids_t *
+    get() const noexcept
+    {
+        return hashids_;
+    }
+
+    /* upper bound of the encoded size, including the terminating NUL */
+    std::size_t
+    max_encoded_size(const std::uint64_t *numbers, std::size_t count)
+        const noexcept
+    {
+        return hashids_estimate_encoded_size(hashids_, count,
+            const_cast<unsigned long long *>(ull(numbers)));
+    }
+
+    /* write the hash of numbers[0..count) to out[0..capacity), followed by
+       a NUL when it fits */
+    result
+    encode(const std::uint64_t *numbers, std::size_t count, char *out,
+        std::size_t capacity) const noexcept
+    {
+        char buffer[stack_size];
+        std::size_t size, length;
+
+        if (!count) {
+            if (capacity) {
+                *out = '\0';
+            }
+            return {0, errc::ok};
+        }
+
+        size = max_encoded_size(numbers, count);
+
+        if (capacity >= size) {
+            return {hashids_encode(hashids_, out, count,
+                const_cast<unsigned long long *>(ull(numbers))), errc::ok};
+        }
+
+        /* the estimate is loose, the hash itself may still fit */
+        if (size > stack_size) {
+            return {size - 1, errc::overflow};
+        }
+
+        length = hashids_encode(hashids_, buffer, count,
+            const_cast<unsigned long long *>(ull(numbers)));
+        if (length > capacity) {
+            return {length, errc::overflow};
+        }
+
+        std::char_traits<char>::copy(out, buffer, length);
+        if (length < capacity) {
+            out[length] = '\0';
+        }
+
+        return {length, errc::ok};
+    }
+
+    /* decode hash into out[0..capacity) */
+    result
+    decode(std::string_view hash, std::uint64_t *out,
+        std::size_t capacity) const noexcept
+    {
+        std::size_t count;
+
+        hashids_errno = HASHIDS_ERROR_OK;
+        count = hashids_numbers_count_n(hashids_, hash.data(), hash.size());
+
+        if (!count) {
+            return {0, static_cast<errc>(hashids_errno)};
+        }
+        if (count > capacity) {
+            return {count, errc::overflow};
+        }
+
+        count = hashids_decode_n(hashids_, hash.data(), hash.size(),
+            ull(out));
+        return {count, static_cast<errc>(hashids_errno)};
+    }
+
+    /* encode into an output iterator */
+    template <class OutputIt>
+    OutputIt
+    encode(const std::uint64_t *numbers, std::size_t count,
+        OutputIt out) const
+    {
+        char buffer[stack_size];
+        std::string heap;
+        std::size_t size = count ? max_encoded_size(numbers, count) : 1;
+        char *p = buffer;
+
+        if (size > stack_size) {
+            heap.resize(size);
+            p = &heap[0];
+        }
+
+        size = encode(numbers, count, p, size).size;
+        for (std::size_t i = 0; i < size; ++i) {
+            *out++ = p[i];
+        }
+
+        return out;
+    }
+
+    std::string
+    encode(const std::uint64_t *numbers, std::size_t count) const
+    {
+        std::string hash;
+
+        encode(numbers, count, std::back_inserter(hash));
+        return hash;
+    }
+
+    std::string
+    encode(std::initializer_list<std::uint64_t> numbers) const
+    {
+        return encode(numbers.begin(), numbers.size());
+    }
+
+    /* decode, throwing std::system_error on invalid hashes */
+    std::vector<std::uint64_t>
+    decode(std::string_view hash) const
+    {
+        std::vector<std::uint64_t> numbers;
+        result decoded;
+
+        decoded = decode(hash, nullptr, 0);
+        if (decoded.error == errc::overflow) {
+            numbers.resize(decoded.size);
+            decoded = decode(hash, numbers.data(), numbers.size());
+        }
+        if (!decoded) {
+            throw std::system_error(decoded.error);
+        }
+
+        numbers.resize(decoded.size);
+        return numbers;
+    }
+
+#if __cplusplus >= 202002L
+    result
+    encode(std::span<const std::uint64_t> numbers, std::span<char> out)
+        const noexcept
+    {
+        return encode(numbers.data(), numbers.size(), out.data(),
+            out.size());
+    }
+
+    result
+    decode(std::string_view hash, std::span<std::uint64_t> out)
+        const noexcept
+    {
+        return decode(hash, out.data(), out.size());
+    }
+
+    template <class OutputIt,
+        class = std::enable_if_t<!std::is_integral_v<OutputIt>>>
+    OutputIt
+    encode(std::span<const std::uint64_t> numbers, OutputIt out) const
+    {
+        return encode(numbers.data(), numbers.size(), out);
+    }
+
+    std::string
+    encode(std::span<const std::uint64_t> numbers) const
+    {
+        return encode(numbers.data(), numbers.size());
+    }
+#endif
+
+private:
+    /* the C API takes unsigned long long, which has the same size and
+       representation as std::uint64_t */
+    static_assert(sizeof(unsigned long long) == sizeof(std::uint64_t),
+        "unsigned long long is not 64 bits wide");
+
+    static const unsigned long long *
+    ull(const std::uint64_t *numbers) noexcept
+    {
+        return reinterpret_cast<const unsigned long long *>(numbers);
+    }
+
+    static unsigned long long *
+    ull(std::uint64_t *numbers) noexcept
+    {
+        return reinterpret_cast<unsigned long long *>(numbers);
+    }
+
+    hashids_t *hashids_;
+};
+
+
+#if __cplusplus >= 202002L
+
+/* a string literal usable as a template argument */
+template <std::size_t N>
+struct fixed_string {
+    char data[N] = {};
+
+    constexpr fixed_string(const char (&str)[N]) noexcept
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            data[i] = str[i];
+        }
+    }
+
+    /* up to the first NUL, like strlen() */
+    constexpr std::size_t
+    length() const noexcept
+    {
+        std::size_t i = 0;
+
+        while (i < N && data[i]) {
+            ++i;
+        }
+
+        return i;
+    }
+};
+
+namespace detail {
+
+/* character classes of a static_encoder */
+enum : unsigned char {
+    class_invalid,
+    class_alphabet,
+    class_separator,
+    class_guard
+};
+
+constexpr bool
+contains(const char *str, std::size_t length, char ch) noexcept
+{
+    for (std::size_t i = 0; i < length; ++i) {
+        if (str[i] == ch) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* remove str[index..index+count) */
+constexpr void
+erase(char *str, std::size_t &length, std::size_t index, std::size_t count)
+    noexcept
+{
+    for (std::size_t i = index; i + count < length; ++i) {
+        str[i] = str[i + count];
+    }
+
+    length -= count;
+}
+
+/* hashids_shuffle() */
+constexpr void
+shuffle(char *str, std::size_t length, const char *salt,
+    std::size_t salt_length) noexcept
+{
+    std::size_t i, j, v, p;
+    char temp;
+
+    if (!salt_length) {
+        return;
+    }
+
+    for (i = length - 1, v = 0, p = 0; i > 0 && i < length; --i, ++v) {
+        if (v == salt_length) {
+            v = 0;
+        }
+
+        p += salt[v];
+        j = (salt[v] + v + p) % i;
+
+        temp = str[i];
+        str[i] = str[j];
+        str[j] = temp;
+    }
+}
+
+/* what hashids_init3() derives, in fixed-size arrays */
+template <std::size_t N>
+struct static_state {
+    char alphabet[N] = {};
+    char separators[N] = {};
+    char guards[N] = {};
+    std::size_t alphabet_length = 0;
+    std::size_t separators_count = 0;
+    std::size_t guards_count = 0;
+    unsigned char classes[256] = {};
+    errc error = errc::ok;
+};
+
+/* hashids_init_internal(), step by step; the separator divisor (3.5) is
+   applied in integers: a / s > 3.5 <=> 2a > 7s, ceil(a / 3.5) = (2a + 6) / 7 */
+template <std::size_t N, std::size_t M>
+constexpr static_state<N>
+static_init(const fixed_string<N> &alphabet, const fixed_string<M> &salt)
+    noexcept
+{
+    static_state<N> state;
+    const char separators[] = HASHIDS_DEFAULT_SEPARATORS;
+    const std::size_t length = alphabet.length(),
+        salt_length = salt.length();
+    std::size_t i, j, count;
+
+    /* extract only the unique characters */
+    for (i = 0; i < length; ++i) {
+        if (!contains(state.alphabet, state.alphabet_length,
+                alphabet.data[i])) {
+            state.alphabet[state.alphabet_length++] = alphabet.data[i];
+        }
+    }
+
+    /* check length and whitespace */
+    if (state.alphabet_length < HASHIDS_MIN_ALPHABET_LENGTH) {
+        state.error = errc::alphabet_length;
+        return state;
+    }
+    if (contains(state.alphabet, state.alphabet_length, ' ')
+            || contains(state.alphabet, state.alphabet_length, '\t')) {
+        state.error = errc::alphabet_space;
+        return state;
+    }
+
+    /* take default separators out of the alphabet */
+    for (i = 0; separators[i]; ++i) {
+        for (j = 0; j < state.alphabet_length; ++j) {
+            if (state.alphabet[j] == separators[i]) {
+                state.separators[state.separators_count++] = separators[i];
+                erase(state.alphabet, state.alphabet_length, j, 1);
+                break;
+            }
+        }
+    }
+
+    /* shuffle the separators */
+    shuffle(state.separators, state.separators_count, salt.data,
+        salt_length);
+
+    /* check if we have any/enough separators */
+    if (!state.separators_count
+            || 2 * state.alphabet_length > 7 * state.separators_count) {
+        count = (2 * state.alphabet_length + 6) / 7;
+
+        if (count == 1) {
+            count = 2;
+        }
+
+        if (count > state.separators_count) {
+            /* we need more separators - get some from alphabet */
+            count -= state.separators_count;
+            for (i = 0; i < count; ++i) {
+                state.separators[state.separators_count++] =
+                    state.alphabet[i];
+            }
+            erase(state.alphabet, state.alphabet_length, 0, count);
+        } else {
+            /* we have more than enough - truncate */
+            state.separators_count = count;
+        }
+    }
+
+    /* shuffle alphabet */
+    shuffle(state.alphabet, state.alphabet_length, salt.data, salt_length);
+
+    /* guards */
+    state.guards_count = (state.alphabet_length + 11) / 12;
+    if (state.alphabet_length < 3) {
+        for (i = 0; i < state.guards_count; ++i) {
+            state.guards[i] = state.separators[i];
+        }
+        erase(state.separators, state.separators_count, 0,
+            state.guards_count);
+    } else {
+        for (i = 0; i < state.guards_count; ++i) {
+            state.guards[i] = state.alphabet[i];
+        }
+        erase(state.alphabet, state.alphabet_length, 0, state.guards_count);
+    }
+
+    /* character classes; a NUL ends a hash like a guard does */
+    for (i = 0; i < state.alphabet_length; ++i) {
+        state.classes[(unsigned char)state.alphabet[i]] = class_alphabet;
+    }
+    for (i = 0; i < state.separators_count; ++i) {
+        state.classes[(unsigned char)state.separators[i]] = class_separator;
+    }
+    for (i = 0; i < state.guards_count; ++i) {
+        state.classes[(unsigned char)state.guards[i]] = class_guard;
+    }
+    state.classes[0] = class_guard;
+
+    return state;
+}
+
+} /* namespace detail */
+
+/* an encoder whose salt, alphabet and minimum length are template
+   arguments: the alphabet, separators and guards are derived at compile
+   time, their lengths are constants (so divisions are strength-reduced),
+   and constant numbers can be encoded at compile time; the hashes are the
+   same as the C library's */
+template <fixed_string Salt, fixed_string Alphabet = HASHIDS_DEFAULT_ALPHABET,
+    std::size_t MinLength = HASHIDS_DEFAULT_MIN_HASH_LENGTH>
+class static_encoder {
+    static constexpr auto state_ = detail::static_init(Alphabet, Salt);
+
+    static_assert(state_.error != errc::alphabet_length,
+        "the alphabet needs at least 16 unique characters");
+    static_assert(state_.error != errc::alphabet_space,
+        "the alphabet must not contain spaces or tabs");
+
+public:
+    static constexpr std::size_t salt_length = Salt.length();
+    static constexpr std::size_t min_hash_length = MinLength;
+    static constexpr std::size_t alphabet_length = state_.alphabet_length;
+    static constexpr std::size_t separators_count = state_.separators_count;
+    static constexpr std::size_t guards_count = state_.guards_count;
+
+    /* the exact length of the hash of numbers[0..count) (without NUL) */
+    static constexpr std::size_t
+    encoded_size(const std::uint64_t *numbers, std::size_t count) noexcept
+    {
+        std::size_t length = count;
+
+        if (!count) {
+            return 0;
+        }
+
+        /* lottery + digits + separators */
+        for (std::size_t i = 0; i < count; ++i) {
+            length += digits(numbers[i]);
+        }
+
+        /* guards and padding only depend on the length */
+        if (length < MinLength && ++length < MinLength) {
+            for (++length; length < MinLength; /* empty */) {
+                auto [left, right] = padding(length);
+                length += left + right;
+            }
+        }
+
+        return length;
+    }
+
+    /* write the hash of numbers[0..count) to out[0..capacity), followed by
+       a NUL when it fits */
+    static constexpr result
+    encode(const std::uint64_t *numbers, std::size_t count, char *out,
+        std::size_t capacity) noexcept
+    {
+        char alphabet[alphabet_length], salt[alphabet_length];
+        std::size_t i, j, n, length, size;
+        std::uint64_t number, numbers_hash;
+
+        if (!count) {
+            if (capacity) {
+                *out = '\0';
+            }
+            return {0, errc::ok};
+        }
+
+        size = encoded_size(numbers, count);
+        if (size > capacity) {
+            return {size, errc::overflow};
+        }
+
+        for (i = 0, numbers_hash = 0; i < count; ++i) {
+            numbers_hash += numbers[i] % (i + 100);
+        }
+
+        /* lottery character */
+        out[0] = state_.alphabet[numbers_hash % alphabet_length];
+        length = 1;
+
+        copy(alphabet, state_.alphabet, alphabet_length);
+        salt_init(salt, out[0]);
+
+        for (i = 0; i < count; ++i) {
+            salt_shuffle(alphabet, salt);
+
+            /* the digits, most significant first */
+            number = numbers[i];
+            n = digits(number);
+            for (j = n; j > 0; --j) {
+                out[length + j - 1] = alphabet[number % alphabet_length];
+                number /= alphabet_length;
+            }
+
+            if (i + 1 < count) {
+                number = numbers[i] % (out[length] + i);
+                out[length + n] =
+                    state_.separators[number % separators_count];
+                ++n;
+            }
+
+            length += n;
+        }
+
+        pad(out, length, numbers_hash, alphabet, salt);
+        if (size < capacity) {
+            out[size] = '\0';
+        }
+
+        return {size, errc::ok};
+    }
+
+    /* decode hash into out[0..capacity) */
+    static constexpr result
+    decode(std::string_view hash, std::uint64_t *out, std::size_t capacity)
+        noexcept
+    {
+        char alphabet[alphabet_length], salt[alphabet_length];
+        unsigned char index[256];
+        const char *str = hash.data(), *end = str + hash.size(), *p;
+        std::size_t count, n;
+        std::uint64_t number;
+
+        /* skip the padding up to (and including) the first guard */
+        if constexpr (MinLength > 0) {
+            for (p = str; p < end; ++p) {
+                if (state_.classes[(unsigned char)*p] == detail::class_guard) {
+                    str = p + 1;
+                    break;
+                }
+            }
+        }
+
+        /* an empty hash (the encoding of no numbers) */
+        if (str == end || !*str) {
+            return {0, errc::ok};
+        }
+
+        /* count and validate */
+        for (p = str, count = 1; p < end; ++p) {
+            unsigned char c = state_.classes[(unsigned char)*p];
+
+            if (c == detail::class_guard) {
+                break;
+            }
+            if (c == detail::class_separator) {
+                ++count;
+            } else if (c == detail::class_invalid) {
+                return {0, errc::invalid_hash};
+            }
+        }
+
+        if (count > capacity) {
+            return {count, errc::overflow};
+        }
+
+        copy(alphabet, state_.alphabet, alphabet_length);
+        salt_init(salt, *str++);
+        salt_shuffle(alphabet, salt);
+        index_alphabet(index, alphabet);
+
+        for (number = 0, n = 0; str < end; ++str) {
+            unsigned char c = state_.classes[(unsigned char)*str];
+
+            if (c == detail::class_guard) {
+                break;
+            }
+            if (c == detail::class_separator) {
+                /* as in hashids_decode_n(), not past the count */
+                if (n < count) {
+                    out[n] = number;
+                }
+
+                ++n;
+                number = 0;
+
+                /* resalt the alphabet */
+                salt_shuffle(alphabet, salt);
+                index_alphabet(index, alphabet);
+                continue;
+            }
+            if (c != detail::class_alphabet) {
+                return {0, errc::invalid_hash};
+            }
+
+            number = number * alphabet_length + index[(unsigned char)*str];
+        }
+
+        if (n < count) {
+            out[n] = number;
+        }
+
+        return {count, errc::ok};
+    }
+
+    /* encode into an output iterator */
+    template <class OutputIt,
+        class = std::enable_if_t<!std::is_integral_v<OutputIt>>>
+    static OutputIt
+    encode(const std::uint64_t *numbers, std::size_t count, OutputIt out)
+    {
+        char buffer[encoder::stack_size];
+        std::string heap;
+        std::size_t size = encoded_size(numbers, count);
+        char *p = buffer;
+
+        if (size >= encoder::stack_size) {
+            heap.resize(size + 1);
+            p = &heap[0];
+        }
+
+        encode(numbers, count, p, size + 1);
+        for (std::size_t i = 0; i < size; ++i) {
+            *out++ = p[i];
+        }
+
+        return out;
+    }
+
+    static std::string
+    encode(std::span<const std::uint64_t> numbers)
+    {
+        std::string hash(encoded_size(numbers.data(), numbers.size()), '\0');
+
+        encode(numbers.data(), numbers.size(), hash.data(), hash.size());
+        return hash;
+    }
+
+    static std::string
+    encode(std::initializer_list<std::uint64_t> numbers)
+    {
+        return encode(std::span<const std::uint64_t>(numbers.begin(),
+            numbers.size()));
+    }
+
+    static constexpr result
+    encode(std::span<const std::uint64_t> numbers, std::span<char> out)
+        noexcept
+    {
+        return encode(numbers.data(), numbers.size(), out.data(),
+            out.size());
+    }
+
+    static constexpr result
+    decode(std::string_view hash, std::span<std::uint64_t> out) noexcept
+    {
+        return decode(hash, out.data(), out.size());
+    }
+
+    /* decode, throwing std::system_error on invalid hashes */
+    static std::vector<std::uint64_t>
+    decode(std::string_view hash)
+    {
+        std::vector<std::uint64_t> numbers;
+        result decoded;
+
+        decoded = decode(hash, nullptr, 0);
+        if (decoded.error == errc::overflow) {
+            numbers.resize(decoded.size);
+            decoded = decode(hash, numbers.data(), numbers.size());
+        }
+        if (!decoded) {
+            throw std::system_error(decoded.error);
+        }
+
+        numbers.resize(decoded.size);
+        return numbers;
+    }
+
+private:
+    /* hashids_salt_init(): p_max is how much of the alphabet follows
+       "lottery + salt" in the iteration salt */
+    static constexpr std::ptrdiff_t p_max = (std::ptrdiff_t)alphabet_length
+        - 1 - (std::ptrdiff_t)salt_length;
+
+    template <std::uint64_t... Numbers>
+    static constexpr auto hash_of = [] {
+        constexpr std::array<std::uint64_t, sizeof...(Numbers)> numbers{
+            Numbers...};
+        std::array<char, encoded_size(numbers.data(), numbers.size()) + 1>
+            hash{};
+
+        encode(numbers.data(), numbers.size(), hash.data(), hash.size());
+        return hash;
+    }();
+
+    static constexpr void
+    copy(char *dst, const char *src, std::size_t length) noexcept
+    {
+        for (std::size_t i = 0; i < length; ++i) {
+            dst[i] = src[i];
+        }
+    }
+
+    static constexpr std::size_t
+    digits(std::uint64_t number) noexcept
+    {
+        std::size_t n = 1;
+
+        while (number >= alphabet_length) {
+            number /= alphabet_length;
+            ++n;
+        }
+
+        return n;
+    }
+
+    /* "lottery + salt"; the rest is filled in by salt_shuffle() */
+    static constexpr void
+    salt_init(char *salt, char lottery) noexcept
+    {
+        salt[0] = lottery;
+        copy(salt + 1, Salt.data, salt_length < alphabet_length - 1
+            ? salt_length : alphabet_length - 1);
+    }
+
+    /* re-salt and shuffle the working alphabet before each number */
+    static constexpr void
+    salt_shuffle(char *alphabet, char *salt) noexcept
+    {
+        if constexpr (p_max > 0) {
+            copy(salt + salt_length + 1, alphabet, p_max);
+        }
+
+        detail::shuffle(alphabet, alphabet_length, salt, alphabet_length);
+    }
+
+    static constexpr void
+    index_alphabet(unsigned char *index, const char *alphabet) noexcept
+    {
+        for (std::size_t i = 0; i < alphabet_length; ++i) {
+            index[(unsigned char)alphabet[i]] = (unsigned char)i;
+        }
+    }
+
+    /* characters padded to the left and right of a hash of length */
+    static constexpr std::pair<std::size_t, std::size_t>
+    padding(std::size_t length) noexcept
+    {
+        std::size_t left = (MinLength - length + 1) / 2,
+            right = (MinLength - length) / 2;
+
+        if (left > (alphabet_length + 1) / 2) {
+            left = (alphabet_length + 1) / 2;
+        }
+        if (right > alphabet_length / 2) {
+            right = alphabet_length / 2;
+        }
+
+        /* handle excessively excessive excess */
+        if ((left + right) % 2 == 0 && alphabet_length % 2 == 1) {
+            ++left;
+            --right;
+        }
+
+        return {left, right};
+    }
+
+    /* hashids_encode_pad() */
+    static constexpr void
+    pad(char *out, std::size_t length, std::uint64_t numbers_hash,
+        char *alphabet, char *scratch) noexcept
+    {
+        std::size_t i;
+
+        if (length >= MinLength) {
+            return;
+        }
+
+        /* add a guard before the encoded numbers */
+        for (i = length; i > 0; --i) {
+            out[i] = out[i - 1];
+        }
+        out[0] = state_.guards[(numbers_hash + out[1]) % guards_count];
+        if (++length >= MinLength) {
+            return;
+        }
+
+        /* add a guard after the encoded numbers */
+        out[length] = state_.guards[(numbers_hash + out[2]) % guards_count];
+        ++length;
+
+        /* pad with half alphabet before and after */
+        while (length < MinLength) {
+            auto [left, right] = padding(length);
+
+            copy(scratch, alphabet, alphabet_length);
+            detail::shuffle(alphabet, alphabet_length, scratch,
+                alphabet_length);
+
+            for (i = length; i > 0; --i) {
+                out[i - 1 + left] = out[i - 1];
+            }
+            copy(out, alphabet + alphabet_length - left, left);
+            copy(out + left + length, alphabet, right);
+
+            length += left + right;
+        }
+    }
+
+public:
+    /* the hash of constant numbers, encoded at compile time */
+    template <std::uint64_t... Numbers>
+    static constexpr std::string_view constant{hash_of<Numbers...>.data(),
+        hash_of<Numbers...>.size() - 1};
+};
+
+#endif
+
+} /* namespace hashids */
+
+#endif
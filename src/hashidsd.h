@@ -0,0 +1,84 @@
+#ifndef HASHIDS_HASHIDSD_H
+#define HASHIDS_HASHIDSD_H 1
+
+/* hashidsd wire protocol, shared by the daemon and its test
+
+   Every frame is a 12-byte header followed by a body; all integers are
+   little-endian.
+
+     request:  u32 body_length, u32 id, u8 op, u8 flags (0), u16 tenant
+     response: u32 body_length, u32 id, u8 op, u8 flags (0), u16 status
+
+   Responses come back in request order, with the request's id and op.
+
+     ENCODE  body: u32 items, then per item u32 count, count x u64
+             response: u32 items, then per item u32 length, length bytes
+     DECODE  body: u32 items, then per item u32 length, length bytes
+             response: u32 items, then per item i32 error (a
+             HASHIDS_ERROR_* code), u32 count, count x u64
+     LOOKUP  body: a tenant name (the tenant field is ignored)
+             response: u16 tenant */
+
+#include <stddef.h>
+
+/* frame header size */
+#define HASHIDSD_HEADER_SIZE 12
+
+/* longest request body; longer frames close the connection */
+#define HASHIDSD_BODY_MAX (16u << 20)
+
+/* operations */
+#define HASHIDSD_OP_ENCODE 1
+#define HASHIDSD_OP_DECODE 2
+#define HASHIDSD_OP_LOOKUP 3
+
+/* frame statuses */
+#define HASHIDSD_STATUS_OK 0
+#define HASHIDSD_STATUS_BAD_REQUEST 1
+#define HASHIDSD_STATUS_BAD_TENANT 2
+#define HASHIDSD_STATUS_BAD_OP 3
+
+static inline unsigned int
+hashidsd_load_u16(const unsigned char *p)
+{
+    return (unsigned int)p[0] | (unsigned int)p[1] << 8;
+}
+
+static inline unsigned long
+hashidsd_load_u32(const unsigned char *p)
+{
+    return (unsigned long)p[0] | (unsigned long)p[1] << 8
+        | (unsigned long)p[2] << 16 | (unsigned long)p[3] << 24;
+}
+
+static inline unsigned long long
+hashidsd_load_u64(const unsigned char *p)
+{
+    return (unsigned long long)hashidsd_load_u32(p)
+        | (unsigned long long)hashidsd_load_u32(p + 4) << 32;
+}
+
+static inline void
+hashidsd_store_u16(unsigned char *p, unsigned int value)
+{
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+}
+
+static inline void
+hashidsd_store_u32(unsigned char *p, unsigned long value)
+{
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+static inline void
+hashidsd_store_u64(unsigned char *p, unsigned long long value)
+{
+    hashidsd_store_u32(p, (unsigned long)value);
+    hashidsd_store_u32(p + 4, (unsigned long)(value >> 32));
+}
+
+#endif
@@ -1,10 +1,24 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "hashids.h"
+#include "decimal.h"
 
-enum { COMMAND_ENCODE = 0, COMMAND_DECODE = 1 };
+enum { COMMAND_ENCODE = 0, COMMAND_DECODE = 1, COMMAND_SCAN = 2 };
+
+/* long-only options */
+enum {
+    OPTION_STATS = 256, OPTION_BINARY_IN, OPTION_BINARY_OUT, OPTION_ARITY,
+    OPTION_COLUMN, OPTION_DELIMITER
+};
 
 static void
 usage(const char *program_invocation_name, FILE *out)
@@ -13,17 +27,38 @@ usage(const char *program_invocation_name, FILE *out)
     fputs("Usage:\n", out);
     fprintf(out, "  %s [options] <arguments>\n",
         program_invocation_name);
+    fprintf(out, "  %s [options] [-] < records\n",
+        program_invocation_name);
+    fprintf(out, "  %s [options] -i <file>\n",
+        program_invocation_name);
 
     fputs("\n", out);
     fputs("Options:\n", out);
     fputs("  -e, --encode      set command to encode (default)\n", out);
     fputs("  -d, --decode      set command to decode\n", out);
+    fputs("  -S, --scan        set command to scan text for hashes\n", out);
     fputs("  -s, --salt        set salt [" HASHIDS_DEFAULT_SALT "]\n", out);
     fputs("  -a, --alphabet    set alphabet [" HASHIDS_DEFAULT_ALPHABET "]\n",
         out);
     fprintf(out, "  -l, --min-length  set hash minimum length [%u]\n",
         HASHIDS_DEFAULT_MIN_HASH_LENGTH);
     fputs("  -x, --hex         encode / decode hex strings\n", out);
+    fputs("  -i, --input       stream records from a file (memory mapped)\n",
+        out);
+    fputs("  -j, --jobs        process streamed input on N threads "
+        "(0: one per CPU) [1]\n", out);
+    fputs("      --binary-in   encode packed little-endian uint64 tuples\n",
+        out);
+    fputs("      --binary-out  decode to packed little-endian uint64 tuples\n",
+        out);
+    fputs("      --arity       binary tuple length (0: length-prefixed) [1]\n",
+        out);
+    fputs("      --column      rewrite only field N of delimited records\n",
+        out);
+    fputs("      --delimiter   field delimiter for --column (\\t: tab) [,]\n",
+        out);
+    fputs("      --stats       print instrumentation counters on exit\n",
+        out);
     fputs("  -h, --help        display this help and exit\n", out);
     fputs("  -v, --version     print version information and exit\n", out);
 
@@ -31,6 +66,28 @@ usage(const char *program_invocation_name, FILE *out)
     exit(out == stderr ? EXIT_FAILURE : EXIT_SUCCESS);
 }
 
+static void
+print_stats(void)
+{
+    hashids_stats_t stats;
+
+    if (!hashids_stats(&stats)) {
+        fputs("Hashids: statistics not compiled in "
+            "(configure with --enable-stats)\n", stderr);
+        return;
+    }
+
+    fprintf(stderr, "encodes: %llu\n", stats.encodes);
+    fprintf(stderr, "decodes: %llu\n", stats.decodes);
+    fprintf(stderr, "shuffles: %llu\n", stats.shuffles);
+    fprintf(stderr, "padding_iterations: %llu\n", stats.padding_iterations);
+    fprintf(stderr, "invalid_hashes: %llu\n", stats.invalid_hashes);
+    fprintf(stderr, "encode_cycles: %llu\n", stats.encode_cycles);
+    fprintf(stderr, "decode_cycles: %llu\n", stats.decode_cycles);
+    fprintf(stderr, "cache_hits: %llu\n", stats.cache_hits);
+    fprintf(stderr, "cache_misses: %llu\n", stats.cache_misses);
+}
+
 static unsigned long long
 parse_number(const char *s, char **p)
 {
@@ -49,31 +106,1198 @@ parse_number(const char *s, char **p)
     return strtoull(s, p, radix);
 }
 
+/* streaming I/O block size */
+#define STREAM_BLOCK_SIZE (1 << 20)
+
+/* scan mode: remembered non-hash tokens (direct mapped) */
+#define SCAN_CACHE_SIZE 4096
+#define SCAN_CACHE_TOKEN 31
+
+/* longest length-prefixed binary tuple */
+#define BINARY_TUPLE_MAX (1 << 20)
+
+/* buffered output; a negative fd makes the buffer grow instead of flushing */
+struct output_s {
+    int fd;
+    char *data;
+    size_t length;
+    size_t capacity;
+};
+
+/* a token known not to be a hash */
+struct scan_entry_s {
+    unsigned char length;
+    char token[SCAN_CACHE_TOKEN];
+};
+
+/* per-stream state, reused across records */
+struct stream_s {
+    hashids_t *hashids;
+    unsigned int command;
+    unsigned int hex;
+    unsigned int binary_in;
+    unsigned int binary_out;
+    size_t arity;
+    size_t column;
+    char delimiter;
+    unsigned long long offset;
+    unsigned char classes[256];
+    struct scan_entry_s *scan_cache;
+    unsigned long long *numbers;
+    size_t numbers_capacity;
+    char *buffer;
+    size_t buffer_capacity;
+    size_t errors;
+};
+
+static int
+output_init(struct output_s *out, int fd, size_t capacity)
+{
+    out->fd = fd;
+    out->length = 0;
+    out->capacity = capacity;
+    out->data = malloc(capacity);
+
+    return out->data != NULL;
+}
+
+static int
+output_write(int fd, const char *data, size_t length)
+{
+    ssize_t result;
+
+    while (length) {
+        result = write(fd, data, length);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return 0;
+        }
+
+        data += result;
+        length -= result;
+    }
+
+    return 1;
+}
+
+static int
+output_flush(struct output_s *out)
+{
+    if (!output_write(out->fd, out->data, out->length)) {
+        return 0;
+    }
+
+    out->length = 0;
+    return 1;
+}
+
+static char *
+output_reserve(struct output_s *out, size_t length)
+{
+    size_t capacity;
+    char *data;
+
+    if (out->capacity - out->length >= length) {
+        return out->data + out->length;
+    }
+
+    /* flush and retry */
+    if (out->fd >= 0) {
+        if (!output_flush(out)) {
+            return NULL;
+        }
+
+        if (out->capacity >= length) {
+            return out->data;
+        }
+    }
+
+    /* grow */
+    capacity = out->capacity;
+    while (capacity - out->length < length) {
+        capacity *= 2;
+    }
+
+    if (!(data = realloc(out->data, capacity))) {
+        return NULL;
+    }
+
+    out->data = data;
+    out->capacity = capacity;
+    return out->data + out->length;
+}
+
+static int
+output_append(struct output_s *out, const char *data, size_t length)
+{
+    char *p;
+
+    if (!(p = output_reserve(out, length))) {
+        return 0;
+    }
+
+    memcpy(p, data, length);
+    out->length += length;
+    return 1;
+}
+
+static int
+output_error(struct output_s *err, const char *message, const char *line,
+    size_t length)
+{
+    return output_append(err, "Hashids: ", 9)
+        && output_append(err, message, strlen(message))
+        && (!line || (output_append(err, ": ", 2)
+            && output_append(err, line, length)))
+        && output_append(err, "\n", 1);
+}
+
+static unsigned long long
+load_u64le(const unsigned char *p)
+{
+    return (unsigned long long)p[0] | (unsigned long long)p[1] << 8
+        | (unsigned long long)p[2] << 16 | (unsigned long long)p[3] << 24
+        | (unsigned long long)p[4] << 32 | (unsigned long long)p[5] << 40
+        | (unsigned long long)p[6] << 48 | (unsigned long long)p[7] << 56;
+}
+
+static void
+store_u64le(unsigned char *p, unsigned long long number)
+{
+    int i;
+
+    for (i = 0; i < 8; ++i, number >>= 8) {
+        p[i] = (unsigned char)number;
+    }
+}
+
+static int
+stream_reserve(struct stream_s *stream, size_t numbers_count,
+    size_t buffer_size)
+{
+    unsigned long long *numbers;
+    char *buffer;
+
+    if (numbers_count > stream->numbers_capacity) {
+        numbers = realloc(stream->numbers,
+            numbers_count * sizeof(unsigned long long));
+
+        if (!numbers) {
+            return 0;
+        }
+
+        stream->numbers = numbers;
+        stream->numbers_capacity = numbers_count;
+    }
+
+    if (buffer_size > stream->buffer_capacity) {
+        if (!(buffer = realloc(stream->buffer, buffer_size))) {
+            return 0;
+        }
+
+        stream->buffer = buffer;
+        stream->buffer_capacity = buffer_size;
+    }
+
+    return 1;
+}
+
+/* the output of a failed record: an empty line, an empty tuple or zeros */
+static int
+stream_empty(struct stream_s *stream, struct output_s *out)
+{
+    char *p;
+    size_t size;
+
+    if (!stream->binary_out) {
+        return output_append(out, "\n", 1);
+    }
+
+    size = 8 * (stream->arity ? stream->arity : 1);
+    if (!(p = output_reserve(out, size))) {
+        return 0;
+    }
+
+    memset(p, 0, size);
+    out->length += size;
+    return 1;
+}
+
+/* encode the collected numbers as one output line */
+static int
+stream_encode(struct stream_s *stream, size_t numbers_count,
+    struct output_s *out)
+{
+    if (!stream_reserve(stream, 0,
+            hashids_estimate_encoded_size(stream->hashids, numbers_count,
+                stream->numbers))) {
+        return 0;
+    }
+
+    stream->buffer[0] = '\0';
+    hashids_encode(stream->hashids, stream->buffer, numbers_count,
+        stream->numbers);
+
+    return output_append(out, stream->buffer, strlen(stream->buffer))
+        && output_append(out, "\n", 1);
+}
+
+/* process one value of `length` bytes into one output line; errors leave
+   an empty line */
+static int
+stream_value(struct stream_s *stream, const char *line, size_t length,
+    struct output_s *out, struct output_s *err)
+{
+    size_t numbers_count, i;
+    unsigned long long number;
+    const char *p, *q, *end;
+    unsigned char *o;
+
+    end = line + length;
+
+    if (stream->command == COMMAND_ENCODE) {
+        if (stream->hex) {
+            /* hex digits are copied out to get them terminated */
+            number = (unsigned long long)-1;
+            if (!stream_reserve(stream, 0, length + 1
+                    + hashids_estimate_encoded_size(stream->hashids, 1,
+                        &number))) {
+                return 0;
+            }
+
+            memcpy(stream->buffer, line, length);
+            stream->buffer[length] = '\0';
+
+            if (!hashids_encode_hex(stream->hashids,
+                    stream->buffer + length + 1, stream->buffer)) {
+                ++stream->errors;
+                return output_error(err, "Invalid number", line, length)
+                    && stream_empty(stream, out);
+            }
+
+            p = stream->buffer + length + 1;
+            return output_append(out, p, strlen(p))
+                && output_append(out, "\n", 1);
+        }
+
+        /* collect numbers */
+        numbers_count = 0;
+        p = line;
+
+        for (;;) {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) {
+                ++p;
+            }
+
+            if (p == end) {
+                break;
+            }
+
+            number = decimal_parse(p, end, &q);
+            if (q == p || (q < end && *q != ' ' && *q != '\t'
+                    && *q != ',')) {
+                ++stream->errors;
+                return output_error(err, "Invalid number", line, length)
+                    && stream_empty(stream, out);
+            }
+
+            if (numbers_count == stream->numbers_capacity
+                    && !stream_reserve(stream,
+                        numbers_count ? numbers_count * 2 : 16, 0)) {
+                return 0;
+            }
+
+            stream->numbers[numbers_count++] = number;
+            p = q;
+        }
+
+        return stream_encode(stream, numbers_count, out);
+    }
+
+    /* decode */
+    if (stream->hex) {
+        /* at most 16 hex digits come out */
+        if (!stream_reserve(stream, 0, length + 1 + 17)) {
+            return 0;
+        }
+
+        memcpy(stream->buffer, line, length);
+        stream->buffer[length] = '\0';
+
+        if (!hashids_decode_hex(stream->hashids, stream->buffer,
+                stream->buffer + length + 1)) {
+            ++stream->errors;
+            return output_error(err, "Invalid hash", line, length)
+                && stream_empty(stream, out);
+        }
+
+        p = stream->buffer + length + 1;
+        return output_append(out, p, strlen(p))
+            && output_append(out, "\n", 1);
+    }
+
+    /* an empty hash counts no numbers, without an error */
+    hashids_errno = HASHIDS_ERROR_OK;
+    numbers_count = hashids_numbers_count_n(stream->hashids, line, length);
+
+    if (!numbers_count && hashids_errno) {
+        ++stream->errors;
+        return output_error(err, "Invalid hash", line, length)
+            && stream_empty(stream, out);
+    }
+
+    if (!stream_reserve(stream, numbers_count, 0)) {
+        return 0;
+    }
+
+    numbers_count = hashids_decode_n(stream->hashids, line, length,
+        stream->numbers);
+
+    if (stream->binary_out) {
+        /* fixed arity, or the count first */
+        if (stream->arity && numbers_count != stream->arity) {
+            ++stream->errors;
+            return output_error(err, "Unexpected number count", line, length)
+                && stream_empty(stream, out);
+        }
+
+        o = (unsigned char *)output_reserve(out, 8 * (numbers_count + 1));
+        if (!o) {
+            return 0;
+        }
+
+        if (!stream->arity) {
+            store_u64le(o, numbers_count);
+            out->length += 8;
+            o += 8;
+        }
+
+        for (i = 0; i < numbers_count; ++i, o += 8) {
+            store_u64le(o, stream->numbers[i]);
+        }
+
+        out->length += 8 * numbers_count;
+        return 1;
+    }
+
+    if (!numbers_count) {
+        return output_append(out, "\n", 1);
+    }
+
+    o = (unsigned char *)output_reserve(out,
+        numbers_count * (DECIMAL_MAX_LENGTH + 1));
+    if (!o) {
+        return 0;
+    }
+
+    for (i = 0; i < numbers_count; ++i) {
+        o += decimal_format((char *)o, stream->numbers[i]);
+        *o++ = i + 1 < numbers_count ? ' ' : '\n';
+    }
+
+    out->length = (char *)o - out->data;
+    return 1;
+}
+
+/* locate field `column` (1-based) of a delimited record; quoted fields may
+   contain the delimiter */
+static int
+find_field(const char *line, size_t length, size_t column, char delimiter,
+    size_t *start, size_t *end)
+{
+    size_t i, field = 1;
+    int quoted = 0;
+
+    *start = 0;
+
+    for (i = 0; i < length; ++i) {
+        if (line[i] == '"') {
+            quoted = !quoted;
+        } else if (line[i] == delimiter && !quoted) {
+            if (field == column) {
+                break;
+            }
+
+            ++field;
+            *start = i + 1;
+        }
+    }
+
+    *end = i;
+    return field == column;
+}
+
+/* process one record; in column mode only the selected field is rewritten
+   (emptied on errors) and the other bytes pass through */
+static int
+stream_record(struct stream_s *stream, const char *line, size_t length,
+    struct output_s *out, struct output_s *err)
+{
+    size_t start, end, cr;
+
+    /* tolerate CRLF */
+    cr = length && line[length - 1] == '\r';
+
+    if (!stream->column) {
+        return stream_value(stream, line, length - cr, out, err);
+    }
+
+    if (!find_field(line, length - cr, stream->column, stream->delimiter,
+            &start, &end)) {
+        ++stream->errors;
+        return output_error(err, "Missing column", line, length - cr)
+            && output_append(out, line, length)
+            && output_append(out, "\n", 1);
+    }
+
+    /* keep the quotes */
+    if (end - start >= 2 && line[start] == '"' && line[end - 1] == '"') {
+        ++start;
+        --end;
+    }
+
+    if (!output_append(out, line, start)
+            || !stream_value(stream, line + start, end - start, out, err)) {
+        return 0;
+    }
+
+    /* replace the newline of the value with the rest of the record */
+    out->length--;
+    return output_append(out, line + end, length - end)
+        && output_append(out, "\n", 1);
+}
+
+/* process the packed little-endian tuples in data[0..length) */
+static int
+stream_chunk_binary(struct stream_s *stream, const char *data, size_t length,
+    struct output_s *out, struct output_s *err)
+{
+    const unsigned char *p = (const unsigned char *)data, *end = p + length;
+    unsigned long long count;
+    size_t i;
+
+    while (p < end) {
+        count = stream->arity;
+
+        if (!count) {
+            if (end - p < 8) {
+                break;
+            }
+
+            count = load_u64le(p);
+            p += 8;
+
+            if (count > BINARY_TUPLE_MAX) {
+                ++stream->errors;
+                if (!output_error(err, "Invalid tuple length", NULL, 0)
+                        || !output_append(out, "\n", 1)) {
+                    return 0;
+                }
+                continue;
+            }
+        }
+
+        if ((size_t)(end - p) / 8 < count) {
+            break;
+        }
+
+        if (!stream_reserve(stream, count, 0)) {
+            return 0;
+        }
+
+        for (i = 0; i < count; ++i, p += 8) {
+            stream->numbers[i] = load_u64le(p);
+        }
+
+        if (!stream_encode(stream, count, out)) {
+            return 0;
+        }
+    }
+
+    if (p < end) {
+        ++stream->errors;
+        return output_error(err, "Truncated binary record", NULL, 0);
+    }
+
+    return 1;
+}
+
+/* end of the complete records in data[0..length): the first record
+   boundary past `limit`, or else the last one */
+static size_t
+stream_split(const struct stream_s *stream, const char *data, size_t length,
+    size_t limit)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    size_t size, offset;
+    unsigned long long count;
+    const char *nl;
+
+    /* scanned text splits between any two tokens */
+    if (stream->command == COMMAND_SCAN) {
+        for (offset = limit < length ? limit : length; offset < length
+            && stream->classes[(unsigned char)data[offset]]; ++offset);
+
+        if (offset < length) {
+            return offset + 1;
+        }
+
+        for (offset = length; offset
+            && stream->classes[(unsigned char)data[offset - 1]]; --offset);
+        return offset;
+    }
+
+    if (!stream->binary_in) {
+        if (limit < length
+                && (nl = memchr(data + limit, '\n', length - limit))) {
+            return nl + 1 - data;
+        }
+
+        for (offset = length; offset && data[offset - 1] != '\n'; --offset);
+        return offset;
+    }
+
+    /* fixed arity */
+    if (stream->arity) {
+        size = 8 * stream->arity;
+        if (limit < length && limit / size * size + size <= length) {
+            return limit / size * size + size;
+        }
+
+        return length / size * size;
+    }
+
+    /* length-prefixed tuples; bad lengths span the prefix only */
+    for (offset = 0; offset <= limit && length - offset >= 8;) {
+        count = load_u64le(p + offset);
+        if (count > BINARY_TUPLE_MAX) {
+            size = 8;
+        } else if ((length - offset - 8) / 8 < count) {
+            break;
+        } else {
+            size = 8 + 8 * (size_t)count;
+        }
+
+        offset += size;
+    }
+
+    return offset;
+}
+
+/* report the tokens of data[0..length) that are canonical hashes: they
+   decode, and encode back to the same token */
+static int
+stream_scan(struct stream_s *stream, const char *data, size_t length,
+    struct output_s *out)
+{
+    const unsigned char *classes = stream->classes;
+    const char *p = data, *end = data + length, *start;
+    size_t numbers_count, token_length, i;
+    struct scan_entry_s *entry;
+    unsigned int hash;
+    char *o;
+
+    /* log text repeats its words, so rejections are remembered */
+    if (!stream->scan_cache && !(stream->scan_cache = calloc(SCAN_CACHE_SIZE,
+            sizeof(struct scan_entry_s)))) {
+        return 0;
+    }
+
+    while (p < end) {
+        /* next run of hash characters */
+        while (p < end && !classes[(unsigned char)*p]) {
+            ++p;
+        }
+
+        start = p;
+        while (p < end && classes[(unsigned char)*p]) {
+            ++p;
+        }
+
+        token_length = p - start;
+        if (token_length < 2
+                || token_length < stream->hashids->min_hash_length) {
+            continue;
+        }
+
+        entry = NULL;
+        if (token_length <= SCAN_CACHE_TOKEN) {
+            /* FNV-1a */
+            for (hash = 2166136261u, i = 0; i < token_length; ++i) {
+                hash = (hash ^ (unsigned char)start[i]) * 16777619u;
+            }
+
+            entry = &stream->scan_cache[hash % SCAN_CACHE_SIZE];
+            if (entry->length == token_length
+                    && !memcmp(entry->token, start, token_length)) {
+                continue;
+            }
+        }
+
+        numbers_count = hashids_numbers_count_n(stream->hashids, start,
+            token_length);
+        if (!numbers_count) {
+            goto reject;
+        }
+
+        if (!stream_reserve(stream, numbers_count, 0)) {
+            return 0;
+        }
+
+        numbers_count = hashids_decode_n(stream->hashids, start, token_length,
+            stream->numbers);
+        if (!numbers_count) {
+            goto reject;
+        }
+
+        if (!stream_reserve(stream, 0,
+                hashids_estimate_encoded_size(stream->hashids, numbers_count,
+                    stream->numbers))) {
+            return 0;
+        }
+
+        if (hashids_encode(stream->hashids, stream->buffer, numbers_count,
+                stream->numbers) != token_length
+                || memcmp(stream->buffer, start, token_length)) {
+            goto reject;
+        }
+
+        /* offset, hash and numbers */
+        o = output_reserve(out, DECIMAL_MAX_LENGTH + token_length + 2
+            + numbers_count * (DECIMAL_MAX_LENGTH + 1));
+        if (!o) {
+            return 0;
+        }
+
+        o += decimal_format(o, stream->offset + (start - data));
+        *o++ = '\t';
+        memcpy(o, start, token_length);
+        o += token_length;
+        *o++ = '\t';
+
+        for (i = 0; i < numbers_count; ++i) {
+            o += decimal_format(o, stream->numbers[i]);
+            *o++ = i + 1 < numbers_count ? ' ' : '\n';
+        }
+
+        out->length = o - out->data;
+        continue;
+
+reject:
+        if (entry) {
+            entry->length = (unsigned char)token_length;
+            memcpy(entry->token, start, token_length);
+        }
+    }
+
+    return 1;
+}
+
+/* process the records in data[0..length); the last record need not be
+   terminated */
+static int
+stream_chunk(struct stream_s *stream, const char *data, size_t length,
+    struct output_s *out, struct output_s *err)
+{
+    const char *end = data + length, *nl;
+    int ok;
+
+    if (stream->command == COMMAND_SCAN) {
+        ok = stream_scan(stream, data, length, out);
+        stream->offset += length;
+        return ok;
+    }
+
+    if (stream->binary_in) {
+        return stream_chunk_binary(stream, data, length, out, err);
+    }
+
+    while (data < end) {
+        if (!(nl = memchr(data, '\n', end - data))) {
+            nl = end;
+        }
+
+        if (!stream_record(stream, data, nl - data, out, err)) {
+            return 0;
+        }
+
+        data = nl + 1;
+    }
+
+    return 1;
+}
+
+/* read records from fd until EOF */
+static int
+stream_run(struct stream_s *stream, int fd, struct output_s *out,
+    struct output_s *err)
+{
+    size_t capacity = STREAM_BLOCK_SIZE, length = 0, split;
+    char *block, *p;
+    ssize_t result;
+    int ok = 1;
+
+    /* one spare byte for terminating the last record */
+    if (!(block = malloc(capacity + 1))) {
+        return 0;
+    }
+
+    for (;;) {
+        result = read(fd, block + length, capacity - length);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ok = 0;
+            break;
+        }
+
+        if (!result) {
+            /* unterminated last record */
+            ok = stream_chunk(stream, block, length, out, err);
+            break;
+        }
+
+        length += result;
+
+        /* process complete records, keep the partial one */
+        split = stream_split(stream, block, length, length);
+
+        if (split) {
+            if (!stream_chunk(stream, block, split, out, err)) {
+                ok = 0;
+                break;
+            }
+
+            memmove(block, block + split, length - split);
+            length -= split;
+        } else if (length == capacity) {
+            /* a single record longer than the block */
+            if (!(p = realloc(block, capacity * 2 + 1))) {
+                ok = 0;
+                break;
+            }
+
+            block = p;
+            capacity *= 2;
+        }
+    }
+
+    free(block);
+    return ok;
+}
+
+/* parallel streaming: chunk slot states */
+enum { SLOT_FREE = 0, SLOT_READY, SLOT_BUSY, SLOT_DONE };
+
+/* one input chunk and its outputs */
+struct slot_s {
+    int state;
+    const char *data;
+    char *block;
+    unsigned long long offset;
+    size_t length;
+    size_t capacity;
+    struct output_s out;
+    struct output_s err;
+};
+
+/* chunk ring shared by the reader and the workers */
+struct ring_s {
+    pthread_mutex_t mutex;
+    pthread_cond_t ready;
+    pthread_cond_t done;
+    struct slot_s *slots;
+    size_t slots_count;
+    size_t published;
+    size_t taken;
+    unsigned long long consumed;
+    int quit;
+    int failed;
+};
+
+struct worker_s {
+    pthread_t thread;
+    struct ring_s *ring;
+    struct stream_s stream;
+};
+
+static void *
+stream_worker(void *arg)
+{
+    struct worker_s *worker = arg;
+    struct ring_s *ring = worker->ring;
+    struct slot_s *slot;
+    int ok;
+
+    for (;;) {
+        pthread_mutex_lock(&ring->mutex);
+        while (ring->taken == ring->published && !ring->quit) {
+            pthread_cond_wait(&ring->ready, &ring->mutex);
+        }
+
+        if (ring->taken == ring->published) {
+            pthread_mutex_unlock(&ring->mutex);
+            return NULL;
+        }
+
+        slot = &ring->slots[ring->taken++ % ring->slots_count];
+        slot->state = SLOT_BUSY;
+        pthread_mutex_unlock(&ring->mutex);
+
+        worker->stream.offset = slot->offset;
+        ok = stream_chunk(&worker->stream, slot->data, slot->length,
+            &slot->out, &slot->err);
+
+        pthread_mutex_lock(&ring->mutex);
+        if (!ok) {
+            ring->failed = 1;
+        }
+        slot->state = SLOT_DONE;
+        pthread_cond_broadcast(&ring->done);
+        pthread_mutex_unlock(&ring->mutex);
+    }
+}
+
+/* wait for the chunk in `slot` and write its outputs */
+static int
+ring_retire(struct ring_s *ring, struct slot_s *slot)
+{
+    int ok;
+
+    pthread_mutex_lock(&ring->mutex);
+    while (slot->state != SLOT_DONE) {
+        pthread_cond_wait(&ring->done, &ring->mutex);
+    }
+    pthread_mutex_unlock(&ring->mutex);
+
+    ok = output_write(STDERR_FILENO, slot->err.data, slot->err.length)
+        && output_write(STDOUT_FILENO, slot->out.data, slot->out.length);
+
+    slot->out.length = slot->err.length = 0;
+    slot->state = SLOT_FREE;
+    return ok;
+}
+
+/* publish a filled slot to the workers */
+static void
+ring_publish(struct ring_s *ring, struct slot_s *slot, const char *data,
+    size_t length)
+{
+    slot->data = data;
+    slot->length = length;
+    slot->offset = ring->consumed;
+    ring->consumed += length;
+
+    pthread_mutex_lock(&ring->mutex);
+    slot->state = SLOT_READY;
+    ring->published++;
+    pthread_cond_signal(&ring->ready);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+/* read stdin (or the mapped input) in chunks, process them on `jobs`
+   threads and write the results in input order */
+static int
+stream_parallel(const struct stream_s *config, size_t jobs, const char *map,
+    size_t map_size)
+{
+    struct ring_s ring;
+    struct worker_s *workers;
+    struct slot_s *slot, *next;
+    size_t i, started = 0, length = 0, split, errors = 0, written, offset,
+        capacity;
+    ssize_t result;
+    char *p;
+    int ok = 1;
+
+    memset(&ring, 0, sizeof(ring));
+    ring.slots_count = 2 * jobs;
+    ring.slots = calloc(ring.slots_count, sizeof(struct slot_s));
+    workers = calloc(jobs, sizeof(struct worker_s));
+
+    if (!ring.slots || !workers) {
+        fputs("Hashids: Cannot allocate memory for buffer\n", stderr);
+        free(ring.slots);
+        free(workers);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < ring.slots_count && ok; ++i) {
+        slot = &ring.slots[i];
+        slot->capacity = map ? 0 : STREAM_BLOCK_SIZE;
+        ok = (map || (slot->block = malloc(slot->capacity + 1)) != NULL)
+            && output_init(&slot->out, -1, STREAM_BLOCK_SIZE)
+            && output_init(&slot->err, -1, BUFSIZ);
+    }
+
+    /* the workers share the reentrant hashids_t */
+    for (i = 0; i < jobs; ++i) {
+        workers[i].ring = &ring;
+        workers[i].stream = *config;
+    }
+
+    pthread_mutex_init(&ring.mutex, NULL);
+    pthread_cond_init(&ring.ready, NULL);
+    pthread_cond_init(&ring.done, NULL);
+
+    for (i = 0; i < jobs && ok; ++i, ++started) {
+        ok = !pthread_create(&workers[i].thread, NULL, stream_worker,
+            &workers[i]);
+    }
+
+    written = 0;
+
+    /* mapped input: chunks end at the first record boundary past the
+       block size and are parsed in place */
+    for (offset = 0; ok && map && offset < map_size; offset += length) {
+        length = map_size - offset;
+        if (length > STREAM_BLOCK_SIZE) {
+            split = stream_split(config, map + offset, length,
+                STREAM_BLOCK_SIZE);
+            length = split ? split : length;
+        }
+
+        for (; written + ring.slots_count <= ring.published; ++written) {
+            ok = ring_retire(&ring, &ring.slots[written % ring.slots_count])
+                && ok;
+        }
+
+        ring_publish(&ring, &ring.slots[ring.published % ring.slots_count],
+            map + offset, length);
+    }
+
+    /* stdin */
+    slot = &ring.slots[0];
+    length = 0;
+
+    while (ok && !map) {
+        result = read(STDIN_FILENO, slot->block + length,
+            slot->capacity - length);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ok = 0;
+            break;
+        }
+
+        if (!result) {
+            /* unterminated last record */
+            if (length) {
+                ring_publish(&ring, slot, slot->block, length);
+            }
+            break;
+        }
+
+        length += result;
+        split = stream_split(config, slot->block, length, length);
+
+        if (!split) {
+            /* a single record longer than the block */
+            if (length == slot->capacity) {
+                if (!(p = realloc(slot->block, slot->capacity * 2 + 1))) {
+                    ok = 0;
+                    break;
+                }
+
+                slot->block = p;
+                slot->capacity *= 2;
+            }
+            continue;
+        }
+
+        /* recycle the next slot, writing out its previous chunk */
+        for (; written + ring.slots_count <= ring.published + 1; ++written) {
+            ok = ring_retire(&ring, &ring.slots[written % ring.slots_count])
+                && ok;
+        }
+        next = &ring.slots[(ring.published + 1) % ring.slots_count];
+
+        /* carry the partial record over, leaving room for the next read */
+        length -= split;
+        if (length >= next->capacity) {
+            capacity = 2 * (length > STREAM_BLOCK_SIZE
+                ? length : STREAM_BLOCK_SIZE);
+            if (!(p = realloc(next->block, capacity + 1))) {
+                ok = 0;
+                break;
+            }
+
+            next->block = p;
+            next->capacity = capacity;
+        }
+
+        memcpy(next->block, slot->block + split, length);
+        ring_publish(&ring, slot, slot->block, split);
+        slot = next;
+    }
+
+    /* drain in order */
+    for (; written < ring.published; ++written) {
+        ok = ring_retire(&ring, &ring.slots[written % ring.slots_count])
+            && ok;
+    }
+
+    pthread_mutex_lock(&ring.mutex);
+    ring.quit = 1;
+    pthread_cond_broadcast(&ring.ready);
+    pthread_mutex_unlock(&ring.mutex);
+
+    for (i = 0; i < started; ++i) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    if (!ok || ring.failed) {
+        perror("Hashids");
+        ok = 0;
+    }
+
+    for (i = 0; i < jobs; ++i) {
+        errors += workers[i].stream.errors;
+        free(workers[i].stream.numbers);
+        free(workers[i].stream.buffer);
+        free(workers[i].stream.scan_cache);
+    }
+
+    for (i = 0; i < ring.slots_count; ++i) {
+        free(ring.slots[i].block);
+        free(ring.slots[i].out.data);
+        free(ring.slots[i].err.data);
+    }
+
+    pthread_mutex_destroy(&ring.mutex);
+    pthread_cond_destroy(&ring.ready);
+    pthread_cond_destroy(&ring.done);
+    free(ring.slots);
+    free(workers);
+
+    return ok && !errors ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* map the input file read-only; an empty file maps to "" */
+static const char *
+map_input(const char *path, size_t *size)
+{
+    struct stat st;
+    void *map;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return NULL;
+    }
+
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    *size = st.st_size;
+    if (!*size) {
+        close(fd);
+        return "";
+    }
+
+    map = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    madvise(map, *size, MADV_SEQUENTIAL);
+#endif
+
+    return map;
+}
+
+/* stream stdin (or the mapped input) to stdout */
+static int
+stream_stdio(const struct stream_s *config, const char *map, size_t map_size)
+{
+    struct stream_s stream = *config;
+    struct output_s out, err;
+    int ok;
+
+    if (!output_init(&out, STDOUT_FILENO, STREAM_BLOCK_SIZE)) {
+        fputs("Hashids: Cannot allocate memory for buffer\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    if (!output_init(&err, STDERR_FILENO, BUFSIZ)) {
+        free(out.data);
+        fputs("Hashids: Cannot allocate memory for buffer\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    ok = map
+        ? stream_chunk(&stream, map, map_size, &out, &err)
+        : stream_run(&stream, STDIN_FILENO, &out, &err);
+    ok = output_flush(&err) && ok;
+    ok = output_flush(&out) && ok;
+
+    if (!ok) {
+        perror("Hashids");
+    }
+
+    free(stream.numbers);
+    free(stream.buffer);
+    free(stream.scan_cache);
+    free(out.data);
+    free(err.data);
+
+    return ok && !stream.errors ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int
 main(int argc, char **argv)
 {
     hashids_t *hashids;
     char *salt = HASHIDS_DEFAULT_SALT, *alphabet = HASHIDS_DEFAULT_ALPHABET,
-        *buffer, *p, str[18];
-    unsigned int command = COMMAND_ENCODE, hex = 0;
-    size_t min_hash_length = HASHIDS_DEFAULT_MIN_HASH_LENGTH, numbers_count;
+        *input = NULL, *buffer, *p, str[18];
+    const char *map = NULL;
+    size_t map_size = 0;
+    unsigned int command = COMMAND_ENCODE, hex = 0, binary_in = 0,
+        binary_out = 0;
+    size_t min_hash_length = HASHIDS_DEFAULT_MIN_HASH_LENGTH, numbers_count,
+        jobs = 1, arity = 1, column = 0;
+    char delimiter = ',';
+    struct stream_s config;
     unsigned long long number, *numbers, *numbers_ptr;
     int ch, i, j;
 
     static const struct option longopts[] = {
         {"encode", no_argument, NULL, 'e'},
         {"decode", no_argument, NULL, 'd'},
+        {"scan", no_argument, NULL, 'S'},
         {"salt", required_argument, NULL, 's'},
         {"alphabet", required_argument, NULL, 'a'},
         {"min-length", required_argument, NULL, 'l'},
         {"hex", no_argument, NULL, 'x'},
+        {"input", required_argument, NULL, 'i'},
+        {"jobs", required_argument, NULL, 'j'},
+        {"binary-in", no_argument, NULL, OPTION_BINARY_IN},
+        {"binary-out", no_argument, NULL, OPTION_BINARY_OUT},
+        {"arity", required_argument, NULL, OPTION_ARITY},
+        {"column", required_argument, NULL, OPTION_COLUMN},
+        {"delimiter", required_argument, NULL, OPTION_DELIMITER},
+        {"stats", no_argument, NULL, OPTION_STATS},
         {"help", no_argument, NULL, 'h'},
         {"version", no_argument, NULL, 'v'},
         {NULL, 0, NULL, 0}
     };
 
     /* parse command line options */
-    while ((ch = getopt_long(argc, argv, "+eds:a:l:xhv", longopts, NULL)) != -1) {
+    while ((ch = getopt_long(argc, argv, "+edSs:a:l:xi:j:hv", longopts, NULL)) != -1) {
         switch (ch) {
             case 'e':
                 command = COMMAND_ENCODE;
@@ -81,6 +1305,9 @@ main(int argc, char **argv)
             case 'd':
                 command = COMMAND_DECODE;
                 break;
+            case 'S':
+                command = COMMAND_SCAN;
+                break;
             case 's':
                 salt = optarg;
                 break;
@@ -97,6 +1324,54 @@ main(int argc, char **argv)
             case 'x':
                 hex = 1;
                 break;
+            case 'i':
+                input = optarg;
+                break;
+            case 'j':
+                jobs = strtoul(optarg, &p, 10);
+                if (p == optarg || *p) {
+                    fprintf(stderr, "Invalid number of jobs: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                if (!jobs) {
+                    jobs = sysconf(_SC_NPROCESSORS_ONLN) > 0
+                        ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+                }
+                break;
+            case OPTION_BINARY_IN:
+                binary_in = 1;
+                break;
+            case OPTION_BINARY_OUT:
+                binary_out = 1;
+                break;
+            case OPTION_ARITY:
+                arity = strtoul(optarg, &p, 10);
+                if (p == optarg || *p || arity > BINARY_TUPLE_MAX) {
+                    fprintf(stderr, "Invalid arity: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_COLUMN:
+                column = strtoul(optarg, &p, 10);
+                if (p == optarg || *p || !column) {
+                    fprintf(stderr, "Invalid column: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_DELIMITER:
+                if (!strcmp(optarg, "\\t")) {
+                    delimiter = '\t';
+                } else if (strlen(optarg) == 1 && optarg[0] != '"'
+                        && optarg[0] != '\n') {
+                    delimiter = optarg[0];
+                } else {
+                    fprintf(stderr, "Invalid delimiter: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_STATS:
+                atexit(print_stats);
+                break;
             case 'h':
                 usage(argv[0], stdout);
                 break;
@@ -108,8 +1383,32 @@ main(int argc, char **argv)
         }
     }
 
-    /* no arguments? */
-    if (optind == argc) {
+    /* binary records are numbers, and only streamed */
+    if ((binary_in && (command != COMMAND_ENCODE || hex))
+            || (binary_out && (command != COMMAND_DECODE || hex))
+            || ((binary_in || binary_out) && optind < argc && !(optind + 1
+                == argc && !strcmp(argv[optind], "-")))) {
+        fputs("Hashids: --binary-in streams numbers to encode, --binary-out "
+            "streams decoded numbers\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    /* columns are text records, and only streamed */
+    if (column && (binary_in || binary_out || (optind < argc
+            && !(optind + 1 == argc && !strcmp(argv[optind], "-"))))) {
+        fputs("Hashids: --column streams text records\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    /* scanning is streamed too */
+    if (command == COMMAND_SCAN && (hex || column || (optind < argc
+            && !(optind + 1 == argc && !strcmp(argv[optind], "-"))))) {
+        fputs("Hashids: --scan streams plain text\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    /* no arguments? stream stdin unless it is a terminal */
+    if (optind == argc && !input && isatty(STDIN_FILENO)) {
         usage(argv[0], stderr);
     }
 
@@ -136,6 +1435,49 @@ main(int argc, char **argv)
         return EXIT_FAILURE;
     }
 
+    /* streaming mode */
+    if (input || optind == argc
+            || (optind + 1 == argc && !strcmp(argv[optind], "-"))) {
+        if (input && !(map = map_input(input, &map_size))) {
+            fprintf(stderr, "Hashids: Cannot map %s: %s\n", input,
+                strerror(errno));
+            hashids_free(hashids);
+            return EXIT_FAILURE;
+        }
+
+        memset(&config, 0, sizeof(config));
+        config.hashids = hashids;
+        config.command = command;
+        config.hex = hex;
+        config.binary_in = binary_in;
+        config.binary_out = binary_out;
+        config.arity = arity;
+        config.column = column;
+        config.delimiter = delimiter;
+
+        /* hash characters */
+        for (p = hashids->alphabet; *p; ++p) {
+            config.classes[(unsigned char)*p] = 1;
+        }
+        for (p = hashids->separators; *p; ++p) {
+            config.classes[(unsigned char)*p] = 1;
+        }
+        for (p = hashids->guards; *p; ++p) {
+            config.classes[(unsigned char)*p] = 1;
+        }
+
+        i = jobs > 1
+            ? stream_parallel(&config, jobs, map, map_size)
+            : stream_stdio(&config, map, map_size);
+
+        if (map_size) {
+            munmap((void *)map, map_size);
+        }
+
+        hashids_free(hashids);
+        return i;
+    }
+
     /* encode */
     if (command == COMMAND_ENCODE) {
         /* hex mode */
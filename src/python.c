@@ -0,0 +1,707 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "hashids.h"
+
+/* tuples encoded or decoded between two GIL round trips */
+#define BATCH_CHUNK (1 << 20)
+
+/* a chashids.Hashids object */
+struct hashids_object_s {
+    PyObject_HEAD
+    hashids_t *hashids;
+    size_t tuple_bound;
+    size_t tuple_bound_arity;
+};
+
+/* one chunk of a batch call, split between threads */
+struct batch_s {
+    hashids_t *hashids;
+    size_t arity;
+    size_t count;
+    /* encoding: numbers in, hashes out in fixed-size slots */
+    const unsigned long long *numbers;
+    char *slots;
+    size_t slot_size;
+    size_t *lengths;
+    /* decoding: hashes in, numbers out */
+    const char **hashes;
+    size_t *hash_lengths;
+    unsigned long long *output;
+    size_t failed;
+};
+
+/* a thread's share of a batch */
+struct slice_s {
+    pthread_t thread;
+    struct batch_s *batch;
+    size_t begin;
+    size_t end;
+    size_t failed;
+    int ok;
+};
+
+static PyTypeObject hashids_type;
+
+/* one tuple's hash can't be longer than this (NUL included) */
+static size_t
+tuple_bound(struct hashids_object_s *self, size_t arity)
+{
+    unsigned long long numbers[16];
+    size_t i, bound = 0, count;
+
+    if (self->tuple_bound_arity == arity) {
+        return self->tuple_bound;
+    }
+
+    /* the estimate grows with each number's magnitude */
+    for (i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i) {
+        numbers[i] = 0xFFFFFFFFFFFFFFFFull;
+    }
+    for (i = 0; i < arity; i += count) {
+        count = arity - i < 16 ? arity - i : 16;
+        bound += hashids_estimate_encoded_size(self->hashids, count, numbers)
+            - 1;
+    }
+    if (bound < self->hashids->min_hash_length) {
+        bound = self->hashids->min_hash_length;
+    }
+
+    self->tuple_bound_arity = arity;
+    self->tuple_bound = bound + 1;
+    return self->tuple_bound;
+}
+
+static void *
+slice_encode(void *arg)
+{
+    struct slice_s *slice = arg;
+    struct batch_s *batch = slice->batch;
+    size_t i;
+
+    for (i = slice->begin; i < slice->end; ++i) {
+        batch->lengths[i] = hashids_encode(batch->hashids,
+            batch->slots + i * batch->slot_size, batch->arity,
+            (unsigned long long *)batch->numbers + i * batch->arity);
+    }
+
+    slice->ok = 1;
+    return NULL;
+}
+
+static void *
+slice_decode(void *arg)
+{
+    struct slice_s *slice = arg;
+    struct batch_s *batch = slice->batch;
+    unsigned long long *numbers;
+    size_t i, length, count;
+
+    slice->failed = batch->count;
+
+    for (i = slice->begin; i < slice->end; ++i) {
+        length = batch->hash_lengths[i];
+        numbers = batch->output + i * batch->arity;
+
+        /* only hashes of `arity` numbers fit their row */
+        memset(numbers, 0, batch->arity * sizeof(unsigned long long));
+        count = hashids_numbers_count_n(batch->hashids, batch->hashes[i],
+            length);
+        if (count == batch->arity) {
+            count = hashids_decode_n(batch->hashids, batch->hashes[i],
+                length, numbers);
+        }
+
+        if (count != batch->arity) {
+            memset(numbers, 0, batch->arity * sizeof(unsigned long long));
+            if (slice->failed == batch->count) {
+                slice->failed = i;
+            }
+        }
+    }
+
+    slice->ok = 1;
+    return NULL;
+}
+
+/* run `work` over the batch on `threads` threads; the GIL is released */
+static int
+batch_run(struct batch_s *batch, size_t threads, void *(*work)(void *))
+{
+    struct slice_s stack_slices[16], *slices = stack_slices;
+    size_t i, started;
+    int ok = 1;
+
+    if (threads > batch->count / 1024 + 1) {
+        threads = batch->count / 1024 + 1;
+    }
+    if (threads > sizeof(stack_slices) / sizeof(stack_slices[0])
+            && !(slices = malloc(threads * sizeof(struct slice_s)))) {
+        return 0;
+    }
+
+    for (i = 0; i < threads; ++i) {
+        slices[i].batch = batch;
+        slices[i].begin = batch->count * i / threads;
+        slices[i].end = batch->count * (i + 1) / threads;
+        slices[i].failed = batch->count;
+        slices[i].ok = 0;
+    }
+
+    /* the calling thread takes the first slice */
+    for (started = 1; started < threads; ++started) {
+        if (pthread_create(&slices[started].thread, NULL, work,
+                &slices[started])) {
+            break;
+        }
+    }
+    for (i = started; i < threads; ++i) {
+        work(&slices[i]);
+    }
+    work(&slices[0]);
+
+    batch->failed = batch->count;
+    for (i = 0; i < threads; ++i) {
+        if (i && i < started) {
+            pthread_join(slices[i].thread, NULL);
+        }
+
+        ok = ok && slices[i].ok;
+        if (slices[i].failed < batch->failed) {
+            batch->failed = slices[i].failed;
+        }
+    }
+
+    if (slices != stack_slices) {
+        free(slices);
+    }
+
+    return ok;
+}
+
+/* the thread count argument: 0 means one per CPU */
+static int
+threads_count(Py_ssize_t threads, size_t *count)
+{
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must not be negative");
+        return 0;
+    }
+
+    *count = threads;
+    if (!threads) {
+        *count = sysconf(_SC_NPROCESSORS_ONLN) > 0
+            ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    }
+
+    return 1;
+}
+
+/* a buffer of native 64-bit integers (signed ones as their bit patterns) */
+static int
+buffer_u64(PyObject *object, Py_buffer *view, int flags)
+{
+    const char *format;
+    char order;
+
+    if (PyObject_GetBuffer(object, view, flags | PyBUF_C_CONTIGUOUS
+            | PyBUF_FORMAT)) {
+        return 0;
+    }
+
+    format = view->format ? view->format : "B";
+    order = *format;
+    if (order == '@' || order == '=' || order == '<' || order == '>'
+            || order == '!') {
+        ++format;
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if (order == '<') {
+#else
+    if (order == '>' || order == '!') {
+#endif
+        order = 0;
+    }
+
+    if (!order || view->itemsize != 8 || !format[0] || format[1]
+            || !strchr("qQlL", format[0])) {
+        PyErr_Format(PyExc_TypeError, "expected a buffer of native 64-bit "
+            "integers, got format '%s'", view->format ? view->format : "B");
+        PyBuffer_Release(view);
+        return 0;
+    }
+
+    return 1;
+}
+
+static int
+initialized(struct hashids_object_s *self)
+{
+    if (!self->hashids) {
+        PyErr_SetString(PyExc_TypeError, "Hashids is not initialized");
+        return 0;
+    }
+
+    return 1;
+}
+
+static PyObject *
+error_from_errno(void)
+{
+    switch (hashids_errno) {
+        case HASHIDS_ERROR_ALLOC:
+            return PyErr_NoMemory();
+        case HASHIDS_ERROR_ALPHABET_LENGTH:
+            PyErr_SetString(PyExc_ValueError, "alphabet is too short");
+            return NULL;
+        case HASHIDS_ERROR_ALPHABET_SPACE:
+            PyErr_SetString(PyExc_ValueError,
+                "alphabet contains whitespace characters");
+            return NULL;
+        default:
+            PyErr_SetString(PyExc_ValueError, "unknown error");
+            return NULL;
+    }
+}
+
+static int
+hashids_object_init(struct hashids_object_s *self, PyObject *args,
+    PyObject *kwargs)
+{
+    static char *keywords[] = {"salt", "min_length", "alphabet", NULL};
+    const char *salt = HASHIDS_DEFAULT_SALT,
+        *alphabet = HASHIDS_DEFAULT_ALPHABET, *p;
+    Py_ssize_t min_length = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|sns", keywords, &salt,
+            &min_length, &alphabet)) {
+        return -1;
+    }
+
+    if (min_length < 0) {
+        PyErr_SetString(PyExc_ValueError, "min_length must not be negative");
+        return -1;
+    }
+
+    /* hashes are made of alphabet bytes, so they must be characters */
+    for (p = alphabet; *p; ++p) {
+        if ((unsigned char)*p > 127) {
+            PyErr_SetString(PyExc_ValueError, "alphabet must be ASCII");
+            return -1;
+        }
+    }
+
+    /* batch calls use the instance without the GIL */
+    if (self->hashids) {
+        PyErr_SetString(PyExc_TypeError, "Hashids is already initialized");
+        return -1;
+    }
+
+    if (!(self->hashids = hashids_init3(salt, (size_t)min_length,
+            alphabet))) {
+        error_from_errno();
+        return -1;
+    }
+
+    return 0;
+}
+
+static void
+hashids_object_dealloc(struct hashids_object_s *self)
+{
+    hashids_free(self->hashids);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+hashids_object_encode(struct hashids_object_s *self, PyObject *args)
+{
+    unsigned long long stack_numbers[16], *numbers = stack_numbers;
+    Py_ssize_t count = PyTuple_GET_SIZE(args), i;
+    PyObject *result = NULL;
+    char stack_buffer[256], *buffer = stack_buffer;
+    size_t size;
+
+    if (!initialized(self)) {
+        return NULL;
+    }
+
+    if (count > (Py_ssize_t)(sizeof(stack_numbers) / sizeof(stack_numbers[0]))
+            && !(numbers = PyMem_Malloc(count * sizeof(*numbers)))) {
+        return PyErr_NoMemory();
+    }
+
+    for (i = 0; i < count; ++i) {
+        numbers[i] = PyLong_AsUnsignedLongLong(PyTuple_GET_ITEM(args, i));
+        if (numbers[i] == (unsigned long long)-1 && PyErr_Occurred()) {
+            goto done;
+        }
+    }
+
+    size = hashids_estimate_encoded_size(self->hashids, count, numbers);
+    if (size > sizeof(stack_buffer) && !(buffer = PyMem_Malloc(size))) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    size = hashids_encode(self->hashids, buffer, count, numbers);
+    result = PyUnicode_FromStringAndSize(buffer, size);
+
+    if (buffer != stack_buffer) {
+        PyMem_Free(buffer);
+    }
+
+done:
+    if (numbers != stack_numbers) {
+        PyMem_Free(numbers);
+    }
+
+    return result;
+}
+
+/* the bytes of a str (UTF-8) or bytes hash */
+static int
+hash_bytes(PyObject *object, const char **hash, Py_ssize_t *length)
+{
+    if (PyUnicode_Check(object)) {
+        return (*hash = PyUnicode_AsUTF8AndSize(object, length)) != NULL;
+    }
+    if (PyBytes_Check(object)) {
+        *hash = PyBytes_AS_STRING(object);
+        *length = PyBytes_GET_SIZE(object);
+        return 1;
+    }
+
+    PyErr_Format(PyExc_TypeError, "expected str or bytes, got %s",
+        Py_TYPE(object)->tp_name);
+    return 0;
+}
+
+static PyObject *
+hashids_object_decode(struct hashids_object_s *self, PyObject *hash_object)
+{
+    unsigned long long *numbers;
+    const char *hash;
+    Py_ssize_t length;
+    size_t count, i;
+    PyObject *result, *number;
+
+    if (!initialized(self) || !hash_bytes(hash_object, &hash, &length)) {
+        return NULL;
+    }
+
+    /* invalid hashes decode to an empty tuple */
+    count = hashids_numbers_count_n(self->hashids, hash, length);
+    if (!count) {
+        return PyTuple_New(0);
+    }
+
+    if (!(numbers = PyMem_Calloc(count, sizeof(unsigned long long)))) {
+        return PyErr_NoMemory();
+    }
+
+    count = hashids_decode_n(self->hashids, hash, length, numbers);
+
+    if ((result = PyTuple_New(count))) {
+        for (i = 0; i < count; ++i) {
+            if (!(number = PyLong_FromUnsignedLongLong(numbers[i]))) {
+                Py_CLEAR(result);
+                break;
+            }
+
+            PyTuple_SET_ITEM(result, i, number);
+        }
+    }
+
+    PyMem_Free(numbers);
+    return result;
+}
+
+static PyObject *
+hashids_object_encode_batch(struct hashids_object_s *self, PyObject *args,
+    PyObject *kwargs)
+{
+    static char *keywords[] = {"numbers", "arity", "threads", NULL};
+    PyObject *numbers_object, *result = NULL, *hash;
+    Py_ssize_t arity = 1, threads = 1;
+    size_t threads_n, count, done, i;
+    struct batch_s batch;
+    Py_buffer view;
+    int ok;
+
+    if (!initialized(self)
+            || !PyArg_ParseTupleAndKeywords(args, kwargs, "O|nn", keywords,
+            &numbers_object, &arity, &threads)
+            || !threads_count(threads, &threads_n)) {
+        return NULL;
+    }
+
+    if (arity < 1) {
+        PyErr_SetString(PyExc_ValueError, "arity must be positive");
+        return NULL;
+    }
+
+    if (!buffer_u64(numbers_object, &view, PyBUF_SIMPLE)) {
+        return NULL;
+    }
+
+    /* count * arity must not wrap either */
+    count = view.len / 8;
+    if ((size_t)arity > PY_SSIZE_T_MAX / 8 / (count ? count : 1)) {
+        PyErr_SetString(PyExc_OverflowError, "arity is too large");
+        goto done;
+    }
+    if (count % arity) {
+        PyErr_SetString(PyExc_ValueError,
+            "the number of numbers is not a multiple of arity");
+        goto done;
+    }
+    count /= arity;
+
+    memset(&batch, 0, sizeof(batch));
+    batch.hashids = self->hashids;
+    batch.arity = arity;
+    batch.slot_size = count ? tuple_bound(self, arity) : 0;
+    batch.slots = PyMem_RawMalloc((count < BATCH_CHUNK ? count : BATCH_CHUNK)
+        * batch.slot_size + 1);
+    batch.lengths = PyMem_RawMalloc((count < BATCH_CHUNK ? count
+        : BATCH_CHUNK) * sizeof(size_t) + 1);
+
+    if (!batch.slots || !batch.lengths || !(result = PyList_New(count))) {
+        if (!PyErr_Occurred()) {
+            PyErr_NoMemory();
+        }
+        goto free;
+    }
+
+    for (done = 0; done < count; done += batch.count) {
+        batch.count = count - done < BATCH_CHUNK ? count - done : BATCH_CHUNK;
+        batch.numbers = (const unsigned long long *)view.buf + done * arity;
+
+        Py_BEGIN_ALLOW_THREADS
+        ok = batch_run(&batch, threads_n, slice_encode);
+        Py_END_ALLOW_THREADS
+
+        if (!ok) {
+            PyErr_NoMemory();
+            Py_CLEAR(result);
+            goto free;
+        }
+
+        /* hashes are ASCII, as the alphabet is */
+        for (i = 0; i < batch.count; ++i) {
+            if (!(hash = PyUnicode_New(batch.lengths[i], 127))) {
+                Py_CLEAR(result);
+                goto free;
+            }
+
+            memcpy(PyUnicode_DATA(hash), batch.slots + i * batch.slot_size,
+                batch.lengths[i]);
+            PyList_SET_ITEM(result, done + i, hash);
+        }
+    }
+
+free:
+    PyMem_RawFree(batch.slots);
+    PyMem_RawFree(batch.lengths);
+
+done:
+    PyBuffer_Release(&view);
+    return result;
+}
+
+static PyObject *
+hashids_object_decode_batch(struct hashids_object_s *self, PyObject *args,
+    PyObject *kwargs)
+{
+    static char *keywords[] = {"hashes", "arity", "out", "strict", "threads",
+        NULL};
+    PyObject *hashes_object, *out = Py_None, *hashes = NULL, *result = NULL,
+        *module, *zero;
+    Py_ssize_t arity = 1, threads = 1, length, i;
+    int strict = 1, ok;
+    size_t threads_n, count, done;
+    struct batch_s batch;
+    Py_buffer view;
+
+    if (!initialized(self)
+            || !PyArg_ParseTupleAndKeywords(args, kwargs, "O|nOpn", keywords,
+            &hashes_object, &arity, &out, &strict, &threads)
+            || !threads_count(threads, &threads_n)) {
+        return NULL;
+    }
+
+    if (arity < 1) {
+        PyErr_SetString(PyExc_ValueError, "arity must be positive");
+        return NULL;
+    }
+
+    /* a tuple keeps the hashes alive while the GIL is released */
+    if (!(hashes = PySequence_Tuple(hashes_object))) {
+        return NULL;
+    }
+    count = PyTuple_GET_SIZE(hashes);
+
+    /* count * arity numbers, in bytes, must fit a Py_ssize_t */
+    if ((size_t)arity > PY_SSIZE_T_MAX / 8 / (count ? count : 1)) {
+        PyErr_SetString(PyExc_OverflowError, "arity is too large");
+        goto done;
+    }
+
+    /* the output: the caller's buffer, or a new array('Q') */
+    if (out == Py_None) {
+        if (!(module = PyImport_ImportModule("array"))) {
+            goto done;
+        }
+        zero = PyObject_CallMethod(module, "array", "s[i]", "Q", 0);
+        Py_DECREF(module);
+        if (!zero) {
+            goto done;
+        }
+        out = PySequence_Repeat(zero, count * arity);
+        Py_DECREF(zero);
+        if (!out) {
+            goto done;
+        }
+    } else {
+        Py_INCREF(out);
+    }
+
+    if (!buffer_u64(out, &view, PyBUF_WRITABLE)) {
+        Py_DECREF(out);
+        goto done;
+    }
+
+    if ((size_t)view.len / 8 < count * arity) {
+        PyErr_SetString(PyExc_ValueError, "out is too small");
+        goto release;
+    }
+
+    memset(&batch, 0, sizeof(batch));
+    batch.hashids = self->hashids;
+    batch.arity = arity;
+    batch.hashes = PyMem_RawMalloc((count < BATCH_CHUNK ? count
+        : BATCH_CHUNK) * sizeof(const char *) + 1);
+    batch.hash_lengths = PyMem_RawMalloc((count < BATCH_CHUNK ? count
+        : BATCH_CHUNK) * sizeof(size_t) + 1);
+
+    if (!batch.hashes || !batch.hash_lengths) {
+        PyErr_NoMemory();
+        goto free;
+    }
+
+    for (done = 0; done < count; done += batch.count) {
+        batch.count = count - done < BATCH_CHUNK ? count - done : BATCH_CHUNK;
+        batch.output = (unsigned long long *)view.buf + done * arity;
+
+        for (i = 0; i < (Py_ssize_t)batch.count; ++i) {
+            if (!hash_bytes(PyTuple_GET_ITEM(hashes, done + i),
+                    &batch.hashes[i], &length)) {
+                goto free;
+            }
+
+            batch.hash_lengths[i] = length;
+        }
+
+        Py_BEGIN_ALLOW_THREADS
+        ok = batch_run(&batch, threads_n, slice_decode);
+        Py_END_ALLOW_THREADS
+
+        if (!ok) {
+            PyErr_NoMemory();
+            goto free;
+        }
+
+        if (strict && batch.failed < batch.count) {
+            PyErr_Format(PyExc_ValueError, "invalid hash at index %zu",
+                done + batch.failed);
+            goto free;
+        }
+    }
+
+    Py_INCREF(out);
+    result = out;
+
+free:
+    PyMem_RawFree(batch.hashes);
+    PyMem_RawFree(batch.hash_lengths);
+
+release:
+    PyBuffer_Release(&view);
+    Py_DECREF(out);
+
+done:
+    Py_DECREF(hashes);
+    return result;
+}
+
+static PyMethodDef hashids_object_methods[] = {
+    {"encode", (PyCFunction)hashids_object_encode, METH_VARARGS,
+        "encode(*numbers) -> str\n\nThe hash of the numbers."},
+    {"decode", (PyCFunction)hashids_object_decode, METH_O,
+        "decode(hash) -> tuple\n\nThe numbers of a hash (empty if it is "
+        "invalid)."},
+    {"encode_batch", (PyCFunction)(void (*)(void))hashids_object_encode_batch,
+        METH_VARARGS | METH_KEYWORDS,
+        "encode_batch(numbers, arity=1, threads=1) -> list\n\n"
+        "The hashes of every `arity` numbers of a buffer of 64-bit integers "
+        "(array.array('Q'), numpy.uint64, ...).\nThe GIL is released while "
+        "encoding; threads=0 uses one thread per CPU."},
+    {"decode_batch", (PyCFunction)(void (*)(void))hashids_object_decode_batch,
+        METH_VARARGS | METH_KEYWORDS,
+        "decode_batch(hashes, arity=1, out=None, strict=True, threads=1)\n\n"
+        "Decode a sequence of hashes of `arity` numbers each into `out`, a "
+        "writable buffer of 64-bit integers, or into a new array('Q').\n"
+        "Invalid hashes raise ValueError, or decode to zeros if not strict.\n"
+        "The GIL is released while decoding; threads=0 uses one thread per "
+        "CPU."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyTypeObject hashids_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "chashids.Hashids",
+    .tp_basicsize = sizeof(struct hashids_object_s),
+    .tp_dealloc = (destructor)hashids_object_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Hashids(salt='', min_length=0, alphabet=DEFAULT_ALPHABET)",
+    .tp_methods = hashids_object_methods,
+    .tp_init = (initproc)hashids_object_init,
+    .tp_new = PyType_GenericNew,
+};
+
+static struct PyModuleDef hashids_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "chashids",
+    .m_doc = "Hashids over libhashids, with batch operations on buffers.",
+    .m_size = -1,
+};
+
+PyMODINIT_FUNC
+PyInit_chashids(void)
+{
+    PyObject *module;
+
+    if (PyType_Ready(&hashids_type) < 0
+            || !(module = PyModule_Create(&hashids_module))) {
+        return NULL;
+    }
+
+    Py_INCREF(&hashids_type);
+    if (PyModule_AddObject(module, "Hashids", (PyObject *)&hashids_type)
+            || PyModule_AddStringConstant(module, "DEFAULT_ALPHABET",
+                HASHIDS_DEFAULT_ALPHABET)
+            || PyModule_AddStringConstant(module, "__version__",
+                HASHIDS_VERSION)) {
+        Py_DECREF(&hashids_type);
+        Py_DECREF(module);
+        return NULL;
+    }
+
+    return module;
+}
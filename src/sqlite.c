@@ -0,0 +1,553 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <sqlite3ext.h>
+SQLITE_EXTENSION_INIT1
+
+#include "hashids.h"
+
+/* initialized instances kept per function and connection */
+#define INSTANCES_COUNT 8
+
+/* columns of hashids_decode() */
+enum {
+    COLUMN_VALUE = 0, COLUMN_IDX, COLUMN_SALT, COLUMN_HASH,
+    COLUMN_MIN_HASH_LENGTH, COLUMN_ALPHABET
+};
+
+/* an initialized salt / minimum length / alphabet, referenced by the cache
+   and by function auxdata */
+struct instance_s {
+    hashids_t *hashids;
+    char *salt;
+    char *alphabet;
+    size_t min_hash_length;
+    unsigned long long used;
+    int references;
+};
+
+/* recently used instances */
+struct instances_s {
+    struct instance_s *entries[INSTANCES_COUNT];
+    unsigned long long clock;
+};
+
+struct decode_vtab_s {
+    sqlite3_vtab base;
+    struct instances_s *instances;
+};
+
+struct decode_cursor_s {
+    sqlite3_vtab_cursor base;
+    unsigned long long *numbers;
+    size_t capacity;
+    size_t count;
+    size_t position;
+};
+
+static void
+instance_release(void *ptr)
+{
+    struct instance_s *instance = ptr;
+
+    if (--instance->references) {
+        return;
+    }
+
+    hashids_free(instance->hashids);
+    sqlite3_free(instance->salt);
+    sqlite3_free(instance->alphabet);
+    sqlite3_free(instance);
+}
+
+static int
+instance_matches(const struct instance_s *instance, const char *salt,
+    size_t min_hash_length, const char *alphabet)
+{
+    return instance->min_hash_length == min_hash_length
+        && !strcmp(instance->salt, salt)
+        && !strcmp(instance->alphabet, alphabet);
+}
+
+static void
+instances_destroy(void *ptr)
+{
+    struct instances_s *instances = ptr;
+    size_t i;
+
+    for (i = 0; i < INSTANCES_COUNT; ++i) {
+        if (instances->entries[i]) {
+            instance_release(instances->entries[i]);
+        }
+    }
+
+    sqlite3_free(instances);
+}
+
+/* the cached instance for these settings, initializing it (and evicting
+   the least recently used one) on a miss; NULL with hashids_errno set */
+static struct instance_s *
+instances_get(struct instances_s *instances, const char *salt,
+    size_t min_hash_length, const char *alphabet)
+{
+    struct instance_s *instance, **slot = &instances->entries[0];
+    size_t i;
+
+    for (i = 0; i < INSTANCES_COUNT; ++i) {
+        instance = instances->entries[i];
+
+        if (!instance) {
+            slot = &instances->entries[i];
+            break;
+        }
+        if (instance_matches(instance, salt, min_hash_length, alphabet)) {
+            instance->used = ++instances->clock;
+            return instance;
+        }
+        if (instance->used < (*slot)->used) {
+            slot = &instances->entries[i];
+        }
+    }
+
+    if (!(instance = sqlite3_malloc(sizeof(struct instance_s)))) {
+        hashids_errno = HASHIDS_ERROR_ALLOC;
+        return NULL;
+    }
+
+    instance->salt = sqlite3_mprintf("%s", salt);
+    instance->alphabet = sqlite3_mprintf("%s", alphabet);
+    instance->min_hash_length = min_hash_length;
+    instance->references = 1;
+    instance->used = ++instances->clock;
+    instance->hashids = NULL;
+
+    if (!instance->salt || !instance->alphabet
+            || !(instance->hashids = hashids_init3(salt, min_hash_length,
+                alphabet))) {
+        if (!instance->salt || !instance->alphabet) {
+            hashids_errno = HASHIDS_ERROR_ALLOC;
+        }
+
+        sqlite3_free(instance->salt);
+        sqlite3_free(instance->alphabet);
+        sqlite3_free(instance);
+        return NULL;
+    }
+
+    if (*slot) {
+        instance_release(*slot);
+    }
+    *slot = instance;
+
+    return instance;
+}
+
+static const char *
+error_message(void)
+{
+    switch (hashids_errno) {
+        case HASHIDS_ERROR_ALLOC:
+            return "allocation failed";
+        case HASHIDS_ERROR_ALPHABET_LENGTH:
+            return "alphabet is too short";
+        case HASHIDS_ERROR_ALPHABET_SPACE:
+            return "alphabet contains whitespace characters";
+        default:
+            return "unknown error";
+    }
+}
+
+/* hashids_encode(salt, number, ...) and
+   hashids_encode3(salt, min_hash_length, alphabet, number, ...) */
+static void
+encode_function(sqlite3_context *context, int argc, sqlite3_value **argv,
+    int settings)
+{
+    struct instance_s *instance;
+    const char *salt, *alphabet = HASHIDS_DEFAULT_ALPHABET;
+    sqlite3_int64 min_hash_length = 0;
+    unsigned long long stack_numbers[16], *numbers = stack_numbers;
+    size_t count, size, i;
+    char *buffer, *error;
+
+    if (argc < settings) {
+        error = sqlite3_mprintf("hashids_encode%s: missing settings",
+            settings > 1 ? "3" : "");
+        sqlite3_result_error(context, error, -1);
+        sqlite3_free(error);
+        return;
+    }
+
+    for (i = 0; i < (size_t)argc; ++i) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) {
+            return;
+        }
+    }
+
+    salt = (const char *)sqlite3_value_text(argv[0]);
+    if (settings > 1) {
+        min_hash_length = sqlite3_value_int64(argv[1]);
+        alphabet = (const char *)sqlite3_value_text(argv[2]);
+    }
+
+    if (!salt || !alphabet) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+    if (min_hash_length < 0) {
+        sqlite3_result_error(context,
+            "hashids_encode3: negative minimum length", -1);
+        return;
+    }
+
+    /* constant settings keep their instance across rows */
+    instance = sqlite3_get_auxdata(context, 0);
+    if (!instance || !instance_matches(instance, salt,
+            (size_t)min_hash_length, alphabet)) {
+        instance = instances_get(sqlite3_user_data(context), salt,
+            (size_t)min_hash_length, alphabet);
+        if (!instance) {
+            error = sqlite3_mprintf("hashids_encode: %s", error_message());
+            sqlite3_result_error(context, error, -1);
+            sqlite3_free(error);
+            return;
+        }
+
+        instance->references++;
+        sqlite3_set_auxdata(context, 0, instance, instance_release);
+    }
+
+    count = argc - settings;
+    if (count > sizeof(stack_numbers) / sizeof(stack_numbers[0])
+            && !(numbers = sqlite3_malloc64(count * sizeof(*numbers)))) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    /* negative integers are treated as very big unsigned ones */
+    for (i = 0; i < count; ++i) {
+        if (sqlite3_value_type(argv[settings + i]) != SQLITE_INTEGER) {
+            sqlite3_result_error(context,
+                "hashids_encode: numbers must be integers", -1);
+            goto done;
+        }
+
+        numbers[i] = (unsigned long long)sqlite3_value_int64(
+            argv[settings + i]);
+    }
+
+    size = hashids_estimate_encoded_size(instance->hashids, count, numbers);
+    if (!(buffer = sqlite3_malloc64(size))) {
+        sqlite3_result_error_nomem(context);
+        goto done;
+    }
+
+    size = hashids_encode(instance->hashids, buffer, count, numbers);
+    sqlite3_result_text(context, buffer, (int)size, sqlite3_free);
+
+done:
+    if (numbers != stack_numbers) {
+        sqlite3_free(numbers);
+    }
+}
+
+static void
+encode_function1(sqlite3_context *context, int argc, sqlite3_value **argv)
+{
+    encode_function(context, argc, argv, 1);
+}
+
+static void
+encode_function3(sqlite3_context *context, int argc, sqlite3_value **argv)
+{
+    encode_function(context, argc, argv, 3);
+}
+
+/* hashids_decode(salt, hash [, min_hash_length [, alphabet]]): one row per
+   number */
+static int
+decode_connect(sqlite3 *db, void *aux, int argc, const char *const *argv,
+    sqlite3_vtab **vtab, char **error)
+{
+    struct decode_vtab_s *decode;
+    int result;
+
+    result = sqlite3_declare_vtab(db, "CREATE TABLE x(value INTEGER, "
+        "idx INTEGER, salt HIDDEN, hash HIDDEN, min_hash_length HIDDEN, "
+        "alphabet HIDDEN)");
+    if (result != SQLITE_OK) {
+        return result;
+    }
+
+    if (!(decode = sqlite3_malloc(sizeof(struct decode_vtab_s)))) {
+        return SQLITE_NOMEM;
+    }
+
+    memset(decode, 0, sizeof(struct decode_vtab_s));
+    decode->instances = aux;
+    *vtab = &decode->base;
+
+    sqlite3_vtab_config(db, SQLITE_VTAB_INNOCUOUS);
+    return SQLITE_OK;
+}
+
+static int
+decode_disconnect(sqlite3_vtab *vtab)
+{
+    sqlite3_free(vtab);
+    return SQLITE_OK;
+}
+
+/* the hidden columns are arguments, passed in column order */
+static int
+decode_best_index(sqlite3_vtab *vtab, sqlite3_index_info *info)
+{
+    const struct sqlite3_index_constraint *constraint;
+    int arguments[4] = {-1, -1, -1, -1}, i, column, next = 1;
+
+    for (i = 0, constraint = info->aConstraint; i < info->nConstraint;
+            ++i, ++constraint) {
+        column = constraint->iColumn - COLUMN_SALT;
+
+        if (column < 0 || constraint->op != SQLITE_INDEX_CONSTRAINT_EQ) {
+            continue;
+        }
+        if (!constraint->usable) {
+            return SQLITE_CONSTRAINT;
+        }
+
+        arguments[column] = i;
+    }
+
+    if (arguments[0] < 0 || arguments[1] < 0) {
+        sqlite3_free(vtab->zErrMsg);
+        vtab->zErrMsg = sqlite3_mprintf(
+            "hashids_decode: needs a salt and a hash");
+        return SQLITE_ERROR;
+    }
+
+    info->idxNum = 0;
+    for (column = 0; column < 4; ++column) {
+        if (arguments[column] >= 0) {
+            info->aConstraintUsage[arguments[column]].argvIndex = next++;
+            info->aConstraintUsage[arguments[column]].omit = 1;
+            info->idxNum |= 1 << column;
+        }
+    }
+
+    info->estimatedCost = 1.0;
+    info->estimatedRows = 4;
+
+    return SQLITE_OK;
+}
+
+static int
+decode_open(sqlite3_vtab *vtab, sqlite3_vtab_cursor **cursor)
+{
+    struct decode_cursor_s *decode;
+
+    if (!(decode = sqlite3_malloc(sizeof(struct decode_cursor_s)))) {
+        return SQLITE_NOMEM;
+    }
+
+    memset(decode, 0, sizeof(struct decode_cursor_s));
+    *cursor = &decode->base;
+    return SQLITE_OK;
+}
+
+static int
+decode_close(sqlite3_vtab_cursor *cursor)
+{
+    struct decode_cursor_s *decode = (struct decode_cursor_s *)cursor;
+
+    sqlite3_free(decode->numbers);
+    sqlite3_free(decode);
+    return SQLITE_OK;
+}
+
+static int
+decode_filter(sqlite3_vtab_cursor *cursor, int idx_num, const char *idx_str,
+    int argc, sqlite3_value **argv)
+{
+    struct decode_cursor_s *decode = (struct decode_cursor_s *)cursor;
+    struct decode_vtab_s *vtab = (struct decode_vtab_s *)cursor->pVtab;
+    const char *salt, *hash, *alphabet = HASHIDS_DEFAULT_ALPHABET;
+    sqlite3_int64 min_hash_length = 0;
+    struct instance_s *instance;
+    unsigned long long *numbers;
+    size_t length;
+    int i;
+
+    decode->count = decode->position = 0;
+
+    for (i = 0; i < argc; ++i) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) {
+            return SQLITE_OK;
+        }
+    }
+
+    i = 2;
+    if (idx_num & 4) {
+        min_hash_length = sqlite3_value_int64(argv[i++]);
+    }
+    if (idx_num & 8) {
+        alphabet = (const char *)sqlite3_value_text(argv[i]);
+    }
+
+    salt = (const char *)sqlite3_value_text(argv[0]);
+    hash = (const char *)sqlite3_value_text(argv[1]);
+    length = sqlite3_value_bytes(argv[1]);
+    if (!salt || !hash || !alphabet) {
+        return SQLITE_NOMEM;
+    }
+
+    if (min_hash_length < 0) {
+        sqlite3_free(vtab->base.zErrMsg);
+        vtab->base.zErrMsg = sqlite3_mprintf(
+            "hashids_decode: negative minimum length");
+        return SQLITE_ERROR;
+    }
+
+    instance = instances_get(vtab->instances, salt, (size_t)min_hash_length,
+        alphabet);
+    if (!instance) {
+        sqlite3_free(vtab->base.zErrMsg);
+        vtab->base.zErrMsg = sqlite3_mprintf("hashids_decode: %s",
+            error_message());
+        return SQLITE_ERROR;
+    }
+
+    /* invalid hashes have no rows */
+    decode->count = hashids_numbers_count_n(instance->hashids, hash, length);
+    if (decode->count > decode->capacity) {
+        if (!(numbers = sqlite3_realloc64(decode->numbers,
+                decode->count * sizeof(unsigned long long)))) {
+            decode->count = 0;
+            return SQLITE_NOMEM;
+        }
+
+        decode->numbers = numbers;
+        decode->capacity = decode->count;
+    }
+    if (decode->count) {
+        memset(decode->numbers, 0,
+            decode->count * sizeof(unsigned long long));
+        decode->count = hashids_decode_n(instance->hashids, hash, length,
+            decode->numbers);
+    }
+
+    return SQLITE_OK;
+}
+
+static int
+decode_next(sqlite3_vtab_cursor *cursor)
+{
+    ((struct decode_cursor_s *)cursor)->position++;
+    return SQLITE_OK;
+}
+
+static int
+decode_eof(sqlite3_vtab_cursor *cursor)
+{
+    struct decode_cursor_s *decode = (struct decode_cursor_s *)cursor;
+
+    return decode->position >= decode->count;
+}
+
+static int
+decode_column(sqlite3_vtab_cursor *cursor, sqlite3_context *context,
+    int column)
+{
+    struct decode_cursor_s *decode = (struct decode_cursor_s *)cursor;
+
+    /* numbers above 2^63 - 1 come out negative, as they went in */
+    switch (column) {
+        case COLUMN_VALUE:
+            sqlite3_result_int64(context,
+                (sqlite3_int64)decode->numbers[decode->position]);
+            break;
+        case COLUMN_IDX:
+            sqlite3_result_int64(context, (sqlite3_int64)decode->position);
+            break;
+        default:
+            sqlite3_result_null(context);
+            break;
+    }
+
+    return SQLITE_OK;
+}
+
+static int
+decode_rowid(sqlite3_vtab_cursor *cursor, sqlite3_int64 *rowid)
+{
+    *rowid = (sqlite3_int64)((struct decode_cursor_s *)cursor)->position;
+    return SQLITE_OK;
+}
+
+static sqlite3_module decode_module = {
+    0,                      /* iVersion */
+    NULL,                   /* xCreate: eponymous only */
+    decode_connect,
+    decode_best_index,
+    decode_disconnect,
+    NULL,                   /* xDestroy */
+    decode_open,
+    decode_close,
+    decode_filter,
+    decode_next,
+    decode_eof,
+    decode_column,
+    decode_rowid
+};
+
+static struct instances_s *
+instances_create(void)
+{
+    struct instances_s *instances;
+
+    if ((instances = sqlite3_malloc(sizeof(struct instances_s)))) {
+        memset(instances, 0, sizeof(struct instances_s));
+    }
+
+    return instances;
+}
+
+/* extension entry point */
+int
+sqlite3_hashids_init(sqlite3 *db, char **error,
+    const sqlite3_api_routines *api)
+{
+    const int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS;
+    struct instances_s *instances;
+    int result;
+
+    SQLITE_EXTENSION_INIT2(api);
+
+    if (!(instances = instances_create())) {
+        return SQLITE_NOMEM;
+    }
+    result = sqlite3_create_function_v2(db, "hashids_encode", -1, flags,
+        instances, encode_function1, NULL, NULL, instances_destroy);
+
+    if (result == SQLITE_OK) {
+        if (!(instances = instances_create())) {
+            return SQLITE_NOMEM;
+        }
+        result = sqlite3_create_function_v2(db, "hashids_encode3", -1, flags,
+            instances, encode_function3, NULL, NULL, instances_destroy);
+    }
+
+    if (result == SQLITE_OK) {
+        if (!(instances = instances_create())) {
+            return SQLITE_NOMEM;
+        }
+        result = sqlite3_create_module_v2(db, "hashids_decode",
+            &decode_module, instances, instances_destroy);
+    }
+
+    if (result != SQLITE_OK && error) {
+        *error = sqlite3_mprintf("hashids: %s", sqlite3_errmsg(db));
+    }
+
+    return result;
+}
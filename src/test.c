@@ -2,8 +2,15 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <strings.h>
+#include <pthread.h>
 
-#include "hashids.h"
+#ifdef HASHIDS_TEST_SINGLE_HEADER
+#   define HASHIDS_IMPLEMENTATION
+#   include "hashids_single.h"
+#else
+#   include "hashids.h"
+#endif
 
 #ifndef lengthof
 #define lengthof(x) ((size_t)(sizeof(x) / sizeof(x[0])))
@@ -195,7 +202,81 @@ struct testcase_t testcases[] = {
     {NULL, 0, NULL, 0, {0ull}, NULL}
 };
 
-char *failures[lengthof(testcases)];
+#ifdef HASHIDS_HAVE_INT128
+struct testcase_u128_t {
+    const char *salt;
+    size_t min_hash_length;
+    size_t numbers_count;
+    unsigned long long numbers[4][2];   /* high, low */
+    const char *expected_hash;
+};
+
+struct testcase_u128_t testcases_u128[] = {
+    {"", 0, 1,
+        {{0x1ull, 0x0ull}}, "BEpR8m5g8V6WX"},
+    {"", 0, 1,
+        {{0x6ull, 0xFFFFFFFFFFFFFFF9ull}}, "nZVLKjKNJWrGgl"},
+    {"", 0, 1,
+        {{0xFFFFFFFFFFFFFFFFull, 0xFFFFFFFFFFFFFFFFull}},
+        "w0xzE3QWvmqA4wRw4gnmJAXxJ"},
+    {"this is my salt", 0, 1,
+        {{0x0123456789ABCDEFull, 0x0123456789ABCDEFull}},
+        "zoa3NPpKzY7yZeK2JX7X76zW"},
+    {"this is my salt", 0, 3,
+        {{0x1ull, 0x1ull}, {0x8000000000000000ull, 0x0ull}, {0x0ull, 0x5ull}},
+        "Z3P7OM18Oe6qBuePXNb2E4vz1yJVJLWVvEnpPQfo"},
+    {"this is my salt", 40, 1,
+        {{0x1000000000ull, 0x0ull}}, "yjB9nrL6w03w1nRkmzoXQJ2Yz5M7pR0aZNDPEK47"},
+
+    {NULL, 0, 0, {{0ull, 0ull}}, NULL}
+};
+#endif
+
+struct testcase_bytes_t {
+    const char *salt;
+    size_t min_hash_length;
+    const char *hex;
+    const char *expected_hash;
+};
+
+struct testcase_bytes_t testcases_bytes[] = {
+    {"", 0, "", "jR"},
+    {"", 0, "0000ff", "Qn2317"},
+    {"this is my salt", 0, "000102030405060708090a0b0c0d0e0f10111213",
+        "yDQwqWe1eBpDb4XVKaKqBn842Xk5jwa"},
+    {"this is my salt", 0,
+        "0004080c1014181c2024282c3034383c4044484c5054585c6064686c7074787c"
+        "8084888c9094989ca0a4a8acb0b4b8bcc0c4c8ccd0d4d8dce0e4e8ecf0f4f8fc",
+        "PmLv8mx77OvBv7qjwBqmkWjRK2gO1z83mZalvP3Kxv4MY7mz8wWJgob9booKQJRLke5D"
+        "3B2VaD8E2V56yl54qKmoY36xWaZ"},
+    {"this is my salt", 30, "0102", "lOxNm2Wrvjq4GlBNXA8w1eEZzgXokM"},
+
+    {NULL, 0, NULL, NULL}
+};
+
+struct testcase_hex_t {
+    const char *salt;
+    size_t min_hash_length;
+    const char *hex;
+    const char *expected_hash;
+};
+
+/* an empty `hex` marks a hash that must be rejected */
+struct testcase_hex_t testcases_hex[] = {
+    {"", 0, "C0FFEE", "k7AVov"},
+    {"this is my salt", 0, "507f1f77bcf86cd799439011",
+        "x56QL5Dr4Efom6oN6vWO"},
+    {"this is my salt", 0, "0123456789abc", "qqZYBNrZD9fg"},
+    {"this is my salt", 40, "deadbeef00000000000000000000000000000000",
+        "LlGQbXmQeWmkqIQnqoKqNpjFbVP53P2WDULn605e"},
+    {"", 0, "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+        "JJqPBqYpjMHGB1EByMXkUlzyJzkQ90fy86m8VW72fEy5NyXvAwfKDz8"},
+    {"", 0, "", "e1~g"},
+
+    {NULL, 0, NULL, NULL}
+};
+
+char *failures[lengthof(testcases) + 64];
 
 char *
 f(const char *fmt, ...)
@@ -215,11 +296,923 @@ f(const char *fmt, ...)
     return result;
 }
 
+#ifdef HASHIDS_HAVE_INT128
+/* 128-bit round trips, returns the updated failures count */
+size_t
+test_u128(size_t offset, size_t j)
+{
+    hashids_t *hashids;
+    struct testcase_u128_t testcase;
+    unsigned __int128 numbers[4], decoded[4], wide[16];
+    char buffer[128], hex[33], *wide_buffer;
+    size_t i, k, result;
+    int fail;
+
+    /* 64-bit test cases must encode the same */
+    for (i = 0, fail = 0; testcases[i].salt; ++i) {
+        hashids = hashids_init3(testcases[i].salt,
+            testcases[i].min_hash_length, testcases[i].alphabet);
+        if (!hashids) {
+            continue;
+        }
+
+        for (k = 0; k < testcases[i].numbers_count; ++k) {
+            wide[k] = testcases[i].numbers[k];
+        }
+
+        wide_buffer = calloc(hashids_estimate_encoded_size_u128(hashids,
+            testcases[i].numbers_count, wide), 1);
+        if (wide_buffer) {
+            hashids_encode_u128(hashids, wide_buffer,
+                testcases[i].numbers_count, wide);
+            if (strcmp(wide_buffer, testcases[i].expected_hash) != 0) {
+                fail = 1;
+                failures[j++] = f("#%04d: hashids_encode_u128() returned "
+                    "\"%s\"\n                        expected \"%s\"",
+                    i + 1, wide_buffer, testcases[i].expected_hash);
+            }
+            free(wide_buffer);
+        }
+
+        hashids_free(hashids);
+    }
+    fputc(fail ? 'F' : '.', stdout);
+
+    for (i = 0; testcases_u128[i].salt; ++i) {
+        fail = 1;
+        testcase = testcases_u128[i];
+
+        hashids = hashids_init2(testcase.salt, testcase.min_hash_length);
+        if (!hashids) {
+            failures[j++] = f("#%04d: hashids_init2() failed", offset + i + 1);
+            goto test_end;
+        }
+
+        for (k = 0; k < testcase.numbers_count; ++k) {
+            numbers[k] = ((unsigned __int128)testcase.numbers[k][0] << 64)
+                | testcase.numbers[k][1];
+        }
+
+        hashids_encode_u128(hashids, buffer, testcase.numbers_count, numbers);
+        if (strcmp(buffer, testcase.expected_hash) != 0) {
+            failures[j++] = f("#%04d: hashids_encode_u128() returned \"%s\"\n"
+                "                        expected \"%s\"", offset + i + 1,
+                buffer, testcase.expected_hash);
+            goto test_end;
+        }
+
+        result = hashids_decode_u128(hashids, buffer, decoded);
+        if (result != testcase.numbers_count
+                || memcmp(decoded, numbers, result * sizeof(numbers[0]))) {
+            failures[j++] = f("#%04d: hashids_decode_u128() decoding error",
+                offset + i + 1);
+            goto test_end;
+        }
+
+        fail = 0;
+
+test_end:
+        fputc(fail ? 'F' : '.', stdout);
+        hashids_free(hashids);
+    }
+
+    /* hex round trip & overflow detection */
+    fail = 1;
+    hashids = hashids_init("this is my salt");
+
+    hashids_encode_hex_u128(hashids, buffer,
+        "0123456789abcdef0123456789ABCDEF");
+    if (strcmp(buffer, "zoa3NPpKzY7yZeK2JX7X76zW") != 0) {
+        failures[j++] = f("#%04d: hashids_encode_hex_u128() returned \"%s\"",
+            offset + i + 1, buffer);
+    } else if (hashids_decode_hex_u128(hashids, buffer, hex) != 1
+            || strcmp(hex, "123456789ABCDEF0123456789ABCDEF") != 0) {
+        failures[j++] = f("#%04d: hashids_decode_hex_u128() decoding error",
+            offset + i + 1);
+    } else if (hashids_encode_hex_u128(hashids, buffer,
+            "0123456789abcdef0123456789ABCDEF0") != 0
+            || hashids_errno != HASHIDS_ERROR_INVALID_NUMBER) {
+        failures[j++] = f("#%04d: hashids_encode_hex_u128() accepted 33 "
+            "digits", offset + i + 1);
+    } else if (hashids_decode_u128(hashids, "zoa3NPpKzY7yZeK2JX7X76zWzWzW",
+            decoded) != 0 || hashids_errno != HASHIDS_ERROR_OVERFLOW) {
+        failures[j++] = f("#%04d: hashids_decode_u128() missed an overflow",
+            offset + i + 1);
+    } else {
+        fail = 0;
+    }
+
+    fputc(fail ? 'F' : '.', stdout);
+    hashids_free(hashids);
+
+    /* foreign characters after a guard lottery, which the count misses */
+    fail = 0;
+    hashids = hashids_init("");
+    for (k = 0; k < 2; ++k) {
+        hashids_errno = HASHIDS_ERROR_OK;
+        if (hashids_decode_u128(hashids, k ? "ag~h" : "a1*2",
+                decoded) != 0
+                || hashids_errno != HASHIDS_ERROR_INVALID_HASH) {
+            failures[j++] = f("#%04d: hashids_decode_u128() accepted "
+                "foreign characters", offset + i + 2);
+            fail = 1;
+        }
+    }
+
+    fputc(fail ? 'F' : '.', stdout);
+    hashids_free(hashids);
+
+    return j;
+}
+#endif
+
+/* instrumentation counters, returns the updated failures count */
+size_t
+test_stats(size_t offset, size_t j)
+{
+    hashids_t *hashids;
+    hashids_stats_t stats;
+    unsigned long long number;
+    char buffer[64];
+    int fail = 1;
+
+    hashids = hashids_init2("this is my salt", 18);
+    hashids_stats_reset();
+
+    hashids_encode_one(hashids, buffer, 1ull);
+    hashids_decode(hashids, buffer, &number);
+    hashids_decode(hashids, "aJEDngB0!V05ev1WwP", &number);
+
+    if (!hashids_stats(&stats)) {
+        /* not compiled in, everything must read as zero */
+        if (stats.encodes || stats.decodes) {
+            failures[j++] = f("#%04d: hashids_stats() counted while "
+                "disabled", offset + 1);
+        } else {
+            fail = 0;
+        }
+    } else if (stats.encodes != 1 || stats.decodes != 1
+            || stats.invalid_hashes != 1 || stats.padding_iterations != 1
+            || !stats.shuffles || !stats.encode_cycles) {
+        failures[j++] = f("#%04d: hashids_stats() miscounted", offset + 1);
+    } else {
+        fail = 0;
+    }
+
+    fputc(fail ? 'F' : '.', stdout);
+    hashids_free(hashids);
+
+    return j;
+}
+
+/* chunked hex round trips, returns the updated failures count */
+size_t
+test_hex(size_t offset, size_t j)
+{
+    hashids_t *hashids;
+    struct testcase_hex_t testcase;
+    char buffer[128], hex[128];
+    size_t i, result;
+    int fail;
+
+    for (i = 0; testcases_hex[i].salt; ++i) {
+        fail = 1;
+        testcase = testcases_hex[i];
+
+        hashids = hashids_init2(testcase.salt, testcase.min_hash_length);
+        if (!hashids) {
+            failures[j++] = f("#%04d: hashids_init2() failed", offset + i + 1);
+            goto test_end;
+        }
+
+        /* foreign characters after a guard lottery, which the count
+           misses */
+        if (!*testcase.hex) {
+            hashids_errno = HASHIDS_ERROR_OK;
+            strcpy(buffer, testcase.expected_hash);
+            if (hashids_decode_hex_chunked(hashids, buffer, hex,
+                    sizeof(hex)) != 0
+                    || hashids_errno != HASHIDS_ERROR_INVALID_HASH) {
+                failures[j++] = f("#%04d: hashids_decode_hex_chunked() "
+                    "accepted \"%s\"", offset + i + 1, buffer);
+                goto test_end;
+            }
+
+            fail = 0;
+            goto test_end;
+        }
+
+        hashids_encode_hex_chunked(hashids, buffer, sizeof(buffer),
+            testcase.hex);
+        if (strcmp(buffer, testcase.expected_hash) != 0) {
+            failures[j++] = f("#%04d: hashids_encode_hex_chunked() returned "
+                "\"%s\"\n                        expected \"%s\"",
+                offset + i + 1, buffer, testcase.expected_hash);
+            goto test_end;
+        }
+
+        result = hashids_decode_hex_chunked(hashids, buffer, hex, sizeof(hex));
+        if (result != strlen(testcase.hex)
+                || strcasecmp(hex, testcase.hex) != 0) {
+            failures[j++] = f("#%04d: hashids_decode_hex_chunked() decoding "
+                "error", offset + i + 1);
+            goto test_end;
+        }
+
+        fail = 0;
+
+test_end:
+        fputc(fail ? 'F' : '.', stdout);
+        hashids_free(hashids);
+    }
+
+    /* bounds */
+    fail = 1;
+    hashids = hashids_init("this is my salt");
+
+    if (hashids_encode_hex(hashids, buffer, "0123456789abcdef") != 0
+            || hashids_errno != HASHIDS_ERROR_INVALID_NUMBER) {
+        failures[j++] = f("#%04d: hashids_encode_hex() accepted 16 digits",
+            offset + i + 1);
+    } else if (hashids_encode_hex_chunked(hashids, buffer, 8,
+            "507f1f77bcf86cd799439011") != 0
+            || hashids_errno != HASHIDS_ERROR_OVERFLOW) {
+        failures[j++] = f("#%04d: hashids_encode_hex_chunked() overflowed "
+            "buffer", offset + i + 1);
+    } else if (hashids_decode_hex_chunked(hashids, "x56QL5Dr4Efom6oN6vWO",
+            hex, 24) != 0 || hashids_errno != HASHIDS_ERROR_OVERFLOW) {
+        failures[j++] = f("#%04d: hashids_decode_hex_chunked() overflowed "
+            "output", offset + i + 1);
+    } else {
+        fail = 0;
+    }
+
+    fputc(fail ? 'F' : '.', stdout);
+    hashids_free(hashids);
+
+    return j;
+}
+
+/* byte string round trips, returns the updated failures count */
+size_t
+test_bytes(size_t offset, size_t j)
+{
+    hashids_t *hashids;
+    struct testcase_bytes_t testcase;
+    unsigned char bytes[600], decoded[600];
+    char buffer[1024];
+    size_t i, k, bytes_length, result;
+    unsigned int byte;
+    int fail;
+
+    for (i = 0; testcases_bytes[i].salt; ++i) {
+        fail = 1;
+        testcase = testcases_bytes[i];
+
+        hashids = hashids_init2(testcase.salt, testcase.min_hash_length);
+        if (!hashids) {
+            failures[j++] = f("#%04d: hashids_init2() failed", offset + i + 1);
+            goto test_end;
+        }
+
+        bytes_length = strlen(testcase.hex) / 2;
+        for (k = 0; k < bytes_length; ++k) {
+            sscanf(testcase.hex + k * 2, "%2x", &byte);
+            bytes[k] = byte;
+        }
+
+        hashids_encode_bytes(hashids, buffer, bytes, bytes_length);
+        if (strcmp(buffer, testcase.expected_hash) != 0) {
+            failures[j++] = f("#%04d: hashids_encode_bytes() returned \"%s\"\n"
+                "                        expected \"%s\"", offset + i + 1,
+                buffer, testcase.expected_hash);
+            goto test_end;
+        }
+
+        result = hashids_decode_bytes(hashids, buffer, decoded,
+            sizeof(decoded));
+        if (result != bytes_length || memcmp(decoded, bytes, result)) {
+            failures[j++] = f("#%04d: hashids_decode_bytes() decoding error",
+                offset + i + 1);
+            goto test_end;
+        }
+
+        fail = 0;
+
+test_end:
+        fputc(fail ? 'F' : '.', stdout);
+        hashids_free(hashids);
+    }
+
+    /* long inputs (heap limbs) and short output buffers */
+    fail = 1;
+    hashids = hashids_init("this is my salt");
+    for (k = 0; k < sizeof(bytes); ++k) {
+        bytes[k] = (unsigned char)(k * 7);
+    }
+
+    result = hashids_encode_bytes(hashids, buffer, bytes, sizeof(bytes));
+    if (result + 1 > hashids_estimate_encoded_size_bytes(hashids,
+            sizeof(bytes))) {
+        failures[j++] = f("#%04d: hashids_estimate_encoded_size_bytes() "
+            "underestimated", offset + i + 1);
+    } else if (hashids_decode_bytes(hashids, buffer, decoded,
+            sizeof(decoded)) != sizeof(bytes)
+            || memcmp(decoded, bytes, sizeof(bytes))) {
+        failures[j++] = f("#%04d: hashids_decode_bytes() decoding error",
+            offset + i + 1);
+    } else if (hashids_decode_bytes(hashids, buffer, decoded,
+            sizeof(decoded) - 1) != 0
+            || hashids_errno != HASHIDS_ERROR_OVERFLOW) {
+        failures[j++] = f("#%04d: hashids_decode_bytes() overflowed output",
+            offset + i + 1);
+    } else {
+        fail = 0;
+    }
+
+    fputc(fail ? 'F' : '.', stdout);
+    hashids_free(hashids);
+
+    /* foreign characters after a guard lottery, which the count misses */
+    fail = 0;
+    hashids = hashids_init("");
+    for (k = 0; k < 2; ++k) {
+        hashids_errno = HASHIDS_ERROR_OK;
+        if (hashids_decode_bytes(hashids, k ? "a110!X1" : "a02#", decoded,
+                sizeof(decoded)) != 0
+                || hashids_errno != HASHIDS_ERROR_INVALID_HASH) {
+            failures[j++] = f("#%04d: hashids_decode_bytes() accepted "
+                "foreign characters", offset + i + 2);
+            fail = 1;
+        }
+    }
+
+    fputc(fail ? 'F' : '.', stdout);
+    hashids_free(hashids);
+
+    return j;
+}
+
+/* feed a hash to the incremental decoder, split at `split` (or per byte) */
+static size_t
+decoder_run(hashids_t *hashids, const char *str, size_t length,
+    size_t split, unsigned long long *numbers, size_t numbers_max)
+{
+    hashids_decoder_t decoder;
+    size_t k;
+
+    hashids_decoder_init(&decoder, hashids, numbers, numbers_max);
+    if (split > length) {
+        for (k = 0; k < length; ++k) {
+            hashids_decoder_push(&decoder, str + k, 1);
+        }
+    } else {
+        hashids_decoder_push(&decoder, str, split);
+        hashids_decoder_push(&decoder, str + split, length - split);
+    }
+
+    return hashids_decoder_finish(&decoder);
+}
+
+/* incremental decoding against hashids_decode_n(), returns the updated
+   failures count */
+size_t
+test_decoder(size_t offset, size_t j)
+{
+    static const char *extra = "!\0 cfhistu";
+    hashids_t *hashids;
+    unsigned long long numbers[4], expected[72], decoded[72];
+    unsigned long seed = 1;
+    char buffer[72], ch;
+    size_t i, k, n, length, split, result, count;
+    int fail, expected_errno;
+
+    for (i = 0; i < 3; ++i) {
+        fail = 0;
+        hashids = i == 0 ? hashids_init("this is my salt")
+            : i == 1 ? hashids_init2("this is my salt", 25)
+            : hashids_init3("", 8, "0123456789abcdef");
+
+        for (n = 0; n < 400 && !fail; ++n) {
+            /* a valid hash of 1..4 numbers, then maybe mangled */
+            count = n % 4 + 1;
+            for (k = 0; k < count; ++k) {
+                seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+                numbers[k] = (seed >> 16) >> (seed % 50);
+            }
+            length = hashids_encode(hashids, buffer, count, numbers);
+
+            if (n % 2) {
+                seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+                k = (seed >> 33) % length;
+                ch = n % 6 == 1 ? hashids->guards[(seed >> 8)
+                        % hashids->guards_count]
+                    : n % 6 == 3 ? hashids->separators[(seed >> 8)
+                        % hashids->separators_count]
+                    : extra[(seed >> 8) % 10];
+                buffer[k] = ch;
+            }
+
+            memset(expected, 0, sizeof(expected));
+            hashids_errno = 0;
+            result = hashids_decode_n(hashids, buffer, length, expected);
+            expected_errno = hashids_errno;
+
+            for (split = 0; split <= length + 1 && !fail; ++split) {
+                memset(decoded, 0, sizeof(decoded));
+                hashids_errno = 0;
+                if (decoder_run(hashids, buffer, length, split, decoded,
+                        length + 1) != result
+                        || hashids_errno != expected_errno
+                        || memcmp(decoded, expected,
+                            result * sizeof(decoded[0]))) {
+                    failures[j++] = f("#%04d: hashids_decoder_push() "
+                        "disagrees on hash #%d, split at %d", offset + i + 1,
+                        n, split);
+                    fail = 1;
+                }
+            }
+        }
+
+        /* short output: the count of a hash that does not fit */
+        if (!fail) {
+            length = hashids_encode(hashids, buffer, 4, numbers);
+            hashids_errno = 0;
+            if (decoder_run(hashids, buffer, length, 1, decoded, 2) != 4
+                    || hashids_errno != HASHIDS_ERROR_OVERFLOW
+                    || memcmp(decoded, numbers, 2 * sizeof(numbers[0]))) {
+                failures[j++] = f("#%04d: hashids_decoder_finish() "
+                    "overflowed output", offset + i + 1);
+                fail = 1;
+            }
+        }
+
+        fputc(fail ? 'F' : '.', stdout);
+        hashids_free(hashids);
+    }
+
+    return j;
+}
+
+/* range iterators against hashids_encode_one(), returns the updated
+   failures count */
+size_t
+test_range(size_t offset, size_t j)
+{
+    hashids_t *hashids;
+    hashids_range_t *range;
+    unsigned long long starts[4], number, power;
+    char buffer[128], expected[128];
+    size_t i, k, result;
+    int fail;
+
+    for (i = 0; i < 4; ++i) {
+        fail = 0;
+        hashids = i == 0 ? hashids_init("this is my salt")
+            : i == 1 ? hashids_init2("this is my salt", 25)
+            : i == 2 ? hashids_init3("", 8, "0123456789abcdef")
+            : hashids_init3("x", 5, "abcdefghijklmnop\xe1\xe2\xe3\xe4");
+
+        /* from zero, across a digits count change, up to the maximum */
+        for (power = 1, k = 0; k < 3; ++k) {
+            power *= hashids->alphabet_length;
+        }
+        starts[0] = 0;
+        starts[1] = power - 500;
+        starts[2] = 1000000007ull;
+        starts[3] = ~0ull - 500;
+
+        for (k = 0; k < 4 && !fail; ++k) {
+            range = hashids_range_init(hashids, starts[k], starts[k] + 500);
+
+            for (number = starts[k]; number < starts[k] + 500; ++number) {
+                result = hashids_range_next(range, buffer);
+                if (result != hashids_encode_one(hashids, expected, number)
+                        || strcmp(buffer, expected)) {
+                    failures[j++] = f("#%04d: hashids_range_next() returned "
+                        "\"%s\" for %llu\n                        expected "
+                        "\"%s\"", offset + i + 1, buffer, number, expected);
+                    fail = 1;
+                    break;
+                }
+            }
+
+            /* exhausted */
+            if (!fail && hashids_range_next(range, buffer) != 0) {
+                failures[j++] = f("#%04d: hashids_range_next() ran past "
+                    "the end", offset + i + 1);
+                fail = 1;
+            }
+
+            hashids_range_free(range);
+        }
+
+        fputc(fail ? 'F' : '.', stdout);
+        hashids_free(hashids);
+    }
+
+    return j;
+}
+
+/* encode cache against an uncached instance, returns the updated failures
+   count */
+size_t
+test_cache(size_t offset, size_t j)
+{
+    hashids_t *cached, *plain;
+    hashids_stats_t stats;
+    unsigned long long numbers[3];
+    char buffer[128], expected[128];
+    size_t i, k, count, result;
+    int fail = 0;
+
+    cached = hashids_init2("this is my salt", 12);
+    plain = hashids_init2("this is my salt", 12);
+    hashids_stats_reset();
+
+    /* a few hot tuples among cold ones; triples bypass the cache */
+    if (!hashids_cache_enable(cached, 64, 2)) {
+        failures[j++] = f("#%04d: hashids_cache_enable() failed", offset + 1);
+        fail = 1;
+    }
+    for (i = 0; i < 20000 && !fail; ++i) {
+        count = i % 3 + 1;
+        for (k = 0; k < count; ++k) {
+            numbers[k] = i % 5 ? (i + k) % 7 : ~0ull - i * 7919;
+        }
+
+        result = hashids_encode(cached, buffer, count, numbers);
+        if (result != hashids_encode(plain, expected, count, numbers)
+                || strcmp(buffer, expected)) {
+            failures[j++] = f("#%04d: cached hashids_encode() returned "
+                "\"%s\"\n                        expected \"%s\"",
+                offset + 1, buffer, expected);
+            fail = 1;
+        }
+    }
+
+    if (!fail && hashids_stats(&stats)
+            && (stats.cache_hits < stats.cache_misses
+                || stats.cache_hits + stats.cache_misses != 13334)) {
+        failures[j++] = f("#%04d: hashids_stats() miscounted the cache",
+            offset + 1);
+        fail = 1;
+    }
+
+    /* dropped */
+    if (!fail && (!hashids_cache_enable(cached, 0, 0) || cached->cache)) {
+        failures[j++] = f("#%04d: hashids_cache_enable() kept the cache",
+            offset + 1);
+        fail = 1;
+    }
+
+    fputc(fail ? 'F' : '.', stdout);
+    hashids_free(cached);
+    hashids_free(plain);
+
+    return j;
+}
+
+/* writers evicting each other's long hashes from a one-set cache */
+static volatile int cache_threads_done;
+
+static void *
+cache_writer(void *arg)
+{
+    hashids_t *hashids = arg;
+    char buffer[64];
+    unsigned long long i;
+
+    for (i = 0; !cache_threads_done; ++i) {
+        hashids_encode_one(hashids, buffer, ~0ull - i % 16);
+    }
+
+    return NULL;
+}
+
+/* cache lookups racing with stores, returns the updated failures count */
+size_t
+test_cache_threads(size_t offset, size_t j)
+{
+    hashids_t *hashids;
+    pthread_t writers[3];
+    unsigned long long number = 5;
+    char buffer[64], expected[64];
+    size_t i, k, size;
+    int fail = 0;
+
+    hashids = hashids_init("this is my salt");
+    hashids_encode_one(hashids, expected, number);
+    hashids_cache_enable(hashids, 4, 1);
+    size = hashids_estimate_encoded_size(hashids, 1, &number);
+
+    cache_threads_done = 0;
+    for (k = 0; k < 3; ++k) {
+        pthread_create(&writers[k], NULL, cache_writer, hashids);
+    }
+
+    /* a buffer sized by the estimate, and a canary right after it */
+    for (i = 0; i < 1000000 && !fail; ++i) {
+        memset(buffer, '#', sizeof(buffer));
+        hashids_encode_one(hashids, buffer, number);
+        if (buffer[size] != '#' || strcmp(buffer, expected)) {
+            failures[j++] = f("#%04d: cached hashids_encode_one() wrote "
+                "\"%s\" past its estimate", offset + 1, buffer);
+            fail = 1;
+        }
+    }
+
+    cache_threads_done = 1;
+    for (k = 0; k < 3; ++k) {
+        pthread_join(writers[k], NULL);
+    }
+
+    fputc(fail ? 'F' : '.', stdout);
+    hashids_free(hashids);
+
+    return j;
+}
+
+/* multi-salt decoding, returns the updated failures count */
+size_t
+test_multi(size_t offset, size_t j)
+{
+    hashids_t *hashids[4];
+    hashids_multi_t *multi;
+    unsigned long long numbers[4], decoded[4];
+    unsigned long seed = 7;
+    hashids_stats_t before, after;
+    char buffer[256];
+    size_t i, k, n, count, length, matched, result;
+    int fail = 0, stats_enabled;
+
+    hashids[0] = hashids_init2("new salt", 10);
+    hashids[1] = hashids_init2("old salt", 10);
+    hashids[2] = hashids_init("older salt");
+    hashids[3] = hashids_init3("oldest salt", 0, "0123456789abcdef");
+    multi = hashids_multi_init(hashids, 4);
+
+    for (n = 0; n < 2000 && !fail; ++n) {
+        i = n % 4;
+        count = n / 4 % 4 + 1;
+        for (k = 0; k < count; ++k) {
+            seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+            numbers[k] = (seed >> 16) >> (seed % 50);
+        }
+        length = hashids_encode(hashids[i], buffer, count, numbers);
+
+        /* the salt that made it, with the same numbers (or an earlier
+           salt with other numbers encoding to the same hash) */
+        matched = 99;
+        result = hashids_multi_decode(multi, buffer, length, decoded, 4,
+            &matched);
+        if (result && matched < i) {
+            k = hashids_encode(hashids[matched], buffer + 128, result,
+                decoded);
+            if (k == length && !memcmp(buffer + 128, buffer, length)) {
+                continue;
+            }
+        }
+        if (result != count || matched != i
+                || memcmp(decoded, numbers, count * sizeof(numbers[0]))) {
+            failures[j++] = f("#%04d: hashids_multi_decode(\"%s\") returned "
+                "%d from #%d, expected %d from #%d", offset + 1, buffer,
+                result, matched, count, i);
+            fail = 1;
+        }
+
+        /* not canonical: a changed character, an extra one */
+        buffer[n % length] = buffer[n % length] == 'a' ? 'b' : 'a';
+        if (!fail && hashids_multi_decode(multi, buffer, length, decoded, 4,
+                &matched)
+                && !(hashids_encode(hashids[matched], buffer + 128,
+                    hashids_numbers_count_n(hashids[matched], buffer,
+                        length), decoded) == length
+                    && !memcmp(buffer + 128, buffer, length))) {
+            failures[j++] = f("#%04d: hashids_multi_decode(\"%.*s\") "
+                "accepted a non-canonical hash", offset + 1, length, buffer);
+            fail = 1;
+        }
+    }
+
+    /* too many numbers, unknown bytes */
+    length = hashids_encode(hashids[1], buffer, 4, numbers);
+    if (!fail && (hashids_multi_decode(multi, buffer, length, decoded, 3,
+                &matched)
+            || hashids_errno != HASHIDS_ERROR_OVERFLOW
+            || hashids_multi_decode(multi, "a!b", 3, decoded, 4, &matched)
+            || hashids_errno != HASHIDS_ERROR_INVALID_HASH)) {
+        failures[j++] = f("#%04d: hashids_multi_decode() error handling",
+            offset + 1);
+        fail = 1;
+    }
+
+    /* a match on the last salt: the rejections before it are neither
+       errors nor invalid hashes */
+    numbers[0] = 12345;
+    length = hashids_encode(hashids[3], buffer, 1, numbers);
+    hashids_errno = HASHIDS_ERROR_OK;
+    stats_enabled = hashids_stats(&before);
+    if (!fail && (hashids_multi_decode(multi, buffer, length, decoded, 4,
+                &matched) != 1 || matched != 3 || decoded[0] != 12345
+            || hashids_errno != HASHIDS_ERROR_OK
+            || (stats_enabled && hashids_stats(&after)
+                && after.invalid_hashes != before.invalid_hashes))) {
+        failures[j++] = f("#%04d: hashids_multi_decode(\"%s\") reported "
+            "rejected candidates", offset + 1, buffer);
+        fail = 1;
+    }
+
+    fputc(fail ? 'F' : '.', stdout);
+    hashids_multi_free(multi);
+    for (i = 0; i < 4; ++i) {
+        hashids_free(hashids[i]);
+    }
+
+    return j;
+}
+
+/* strict decoding against decoding then re-encoding, returns the updated
+   failures count */
+size_t
+test_strict(size_t offset, size_t j)
+{
+    static const char *extra = "!\0 cfhistuAG0";
+    hashids_t *hashids;
+    unsigned long long numbers[4], expected[400], decoded[400];
+    unsigned long seed = 3;
+    char buffer[400], encoded[400];
+    size_t i, k, n, count, length, result, reference;
+    int fail;
+
+    for (i = 0; i < 4; ++i) {
+        fail = 0;
+        hashids = i == 0 ? hashids_init("this is my salt")
+            : i == 1 ? hashids_init2("this is my salt", 25)
+            : i == 2 ? hashids_init3("", 8, "0123456789abcdef")
+            : hashids_init2("long", 300);
+
+        for (n = 0; n < 3000 && !fail; ++n) {
+            count = n % 4 + 1;
+            for (k = 0; k < count; ++k) {
+                seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+                numbers[k] = (seed >> 16) >> (seed % 50);
+            }
+            length = hashids_encode(hashids, buffer, count, numbers);
+
+            /* mangle most of them: replace, drop or add a character */
+            seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+            k = (seed >> 33) % length;
+            switch (n % 4) {
+                case 1:
+                    buffer[k] = n % 8 == 1 ? extra[(seed >> 8) % 13]
+                        : hashids->alphabet[(seed >> 8)
+                            % hashids->alphabet_length];
+                    break;
+                case 2:
+                    memmove(buffer + k, buffer + k + 1, length - k);
+                    --length;
+                    break;
+                case 3:
+                    memmove(buffer + k + 1, buffer + k, length - k + 1);
+                    buffer[k] = hashids->alphabet[(seed >> 8)
+                        % hashids->alphabet_length];
+                    ++length;
+                    break;
+            }
+
+            /* the reference: decode, re-encode, compare */
+            reference = hashids_decode_n(hashids, buffer, length, expected);
+            if (reference && (reference > 4
+                    || hashids_encode(hashids, encoded, reference, expected)
+                        != length || memcmp(encoded, buffer, length))) {
+                reference = 0;
+            }
+
+            result = hashids_decode_strict_n(hashids, buffer, length,
+                decoded, 4);
+            if (result != reference || memcmp(decoded, expected,
+                    result * sizeof(decoded[0]))) {
+                failures[j++] = f("#%04d: hashids_decode_strict_n(\"%.*s\") "
+                    "returned %d, expected %d", offset + i + 1, length,
+                    buffer, result, reference);
+                fail = 1;
+            }
+        }
+
+        fputc(fail ? 'F' : '.', stdout);
+        hashids_free(hashids);
+    }
+
+    return j;
+}
+
+/* a guard taken for the lottery: decoders store no more numbers than
+   hashids_numbers_count_n() counts, returns the updated failures count */
+size_t
+test_guard_lottery(size_t offset, size_t j)
+{
+    hashids_t *hashids;
+    unsigned long long numbers[4];
+    hashids_decoder_t decoder;
+#ifdef HASHIDS_HAVE_INT128
+    unsigned __int128 wide[4];
+#endif
+    char buffer[16];
+    size_t count;
+    int fail = 0;
+
+    hashids = hashids_init("this is my salt");
+
+    /* guard, digit, separator, digit, separator, digit */
+    buffer[0] = hashids->guards[0];
+    buffer[1] = hashids->alphabet[0];
+    buffer[2] = hashids->separators[0];
+    buffer[3] = hashids->alphabet[1];
+    buffer[4] = hashids->separators[1];
+    buffer[5] = hashids->alphabet[2];
+    buffer[6] = '\0';
+
+    count = hashids_numbers_count(hashids, buffer);
+    memset(numbers, 0xA5, sizeof(numbers));
+    if (hashids_decode_n(hashids, buffer, 6, numbers) != count
+            || numbers[count] != 0xA5A5A5A5A5A5A5A5ull
+            || hashids_decode(hashids, buffer, numbers) != count
+            || numbers[count] != 0xA5A5A5A5A5A5A5A5ull) {
+        failures[j++] = f("#%04d: hashids_decode() stored past the count "
+            "of \"%s\"", offset + 1, buffer);
+        fail = 1;
+    }
+
+    memset(numbers, 0xA5, sizeof(numbers));
+    hashids_decoder_init(&decoder, hashids, numbers, 4);
+    hashids_decoder_push(&decoder, buffer, 6);
+    if (!fail && (hashids_decoder_finish(&decoder) != count
+            || numbers[count] != 0xA5A5A5A5A5A5A5A5ull)) {
+        failures[j++] = f("#%04d: hashids_decoder_finish() stored past the "
+            "count of \"%s\"", offset + 1, buffer);
+        fail = 1;
+    }
+
+#ifdef HASHIDS_HAVE_INT128
+    memset(wide, 0xA5, sizeof(wide));
+    if (!fail && (hashids_decode_u128(hashids, buffer, wide) != count
+            || (unsigned long long)wide[count] != 0xA5A5A5A5A5A5A5A5ull)) {
+        failures[j++] = f("#%04d: hashids_decode_u128() stored past the "
+            "count of \"%s\"", offset + 1, buffer);
+        fail = 1;
+    }
+#endif
+
+    fputc(fail ? 'F' : '.', stdout);
+    hashids_free(hashids);
+
+    return j;
+}
+
+/* empty hashes (the encoding of no numbers), also after padding: counting
+   and decoding agree, returns the updated failures count */
+size_t
+test_empty(size_t offset, size_t j)
+{
+    hashids_t *hashids;
+    unsigned long long numbers[1];
+    char buffer[4];
+    size_t i;
+    int fail = 0;
+
+    for (i = 0; i < 2 && !fail; ++i) {
+        hashids = i ? hashids_init2("this is my salt", 25) : hashids_init("");
+
+        /* "", then padding up to a guard */
+        buffer[0] = i ? hashids->alphabet[0] : '\0';
+        buffer[1] = hashids->guards[0];
+        buffer[2] = '\0';
+
+        hashids_errno = HASHIDS_ERROR_OK;
+        if (hashids_numbers_count(hashids, i ? buffer : "") != 0
+                || hashids_decode(hashids, i ? buffer : "", numbers) != 0
+                || hashids_decode(hashids, i ? buffer : "", NULL) != 0
+                || hashids_decode_n(hashids, buffer, 0, numbers) != 0
+                || hashids_errno != HASHIDS_ERROR_OK) {
+            failures[j++] = f("#%04d: empty hash \"%s\" counted or decoded "
+                "to numbers", offset + 1, i ? buffer : "");
+            fail = 1;
+        }
+
+        hashids_free(hashids);
+    }
+
+    fputc(fail ? 'F' : '.', stdout);
+
+    return j;
+}
+
 int
 main(int argc, char **argv)
 {
     hashids_t *hashids = NULL;
-    size_t i, j, result;
+    size_t i, j, result, samples;
     char *buffer = NULL;
     unsigned long long numbers[16];
     struct testcase_t testcase;
@@ -322,6 +1315,20 @@ main(int argc, char **argv)
             goto test_end;
         }
 
+        /* length-delimited decode, with the terminator overwritten */
+        buffer[strlen(buffer)] = testcase.alphabet[0];
+        memset(numbers, 0, sizeof(numbers));
+        result = hashids_decode_n(hashids, buffer,
+            strlen(testcase.expected_hash), numbers);
+
+        if (result != testcase.numbers_count || memcmp(numbers,
+                testcase.numbers, result * sizeof(unsigned long long))) {
+            fail = 1;
+            failures[j++] = f("#%04d: hashids_decode_n() decoding error",
+                i + 1);
+            goto test_end;
+        }
+
 test_end:
         fputc(fail ? 'F' : '.', stdout);
 
@@ -333,8 +1340,47 @@ test_end:
         }
     }
 
+    j = test_stats(i, j);
+    i += 1;
+
+    j = test_hex(i, j);
+    i += lengthof(testcases_hex);
+
+    j = test_bytes(i, j);
+    i += lengthof(testcases_bytes) + 1;
+
+    j = test_decoder(i, j);
+    i += 3;
+
+    j = test_range(i, j);
+    i += 4;
+
+    j = test_cache(i, j);
+    i += 1;
+
+    j = test_cache_threads(i, j);
+    i += 1;
+
+    j = test_multi(i, j);
+    i += 1;
+
+    j = test_strict(i, j);
+    i += 4;
+
+    j = test_guard_lottery(i, j);
+    i += 1;
+
+    j = test_empty(i, j);
+    i += 1;
+
+#ifdef HASHIDS_HAVE_INT128
+    j = test_u128(i, j);
+    i += lengthof(testcases_u128) + 2;
+#endif
+
     printf("\n\n");
 
+    samples = i;
     for (i = 0; i < j; ++i) {
         printf("%s\n", failures[i]);
         free(failures[i]);
@@ -344,7 +1390,7 @@ test_end:
         printf("\n");
     }
 
-    printf("%lu samples, %lu failures\n", lengthof(testcases) - 1, j);
+    printf("%lu samples, %lu failures\n", samples, j);
 
     return j ? EXIT_FAILURE : EXIT_SUCCESS;
 }
@@ -0,0 +1,404 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "hashids.h"
+#include "hashidsd.h"
+
+/* tenants of the test configuration, in file order */
+static const struct {
+    const char *name;
+    const char *salt;
+    size_t min_hash_length;
+    const char *alphabet;
+} tenants[] = {
+    {"plain", "", 0, HASHIDS_DEFAULT_ALPHABET},
+    {"salted", "this is my salt", 8, HASHIDS_DEFAULT_ALPHABET},
+    {"hex", "x", 3, "0123456789abcdef"}
+};
+
+#define TENANTS_COUNT (sizeof(tenants) / sizeof(tenants[0]))
+
+/* frames sent before the first response is read */
+#define PIPELINED 64
+
+static hashids_t *hashids[TENANTS_COUNT];
+static size_t samples, failures;
+
+static void
+check(int ok, const char *what)
+{
+    ++samples;
+    if (ok) {
+        printf(".");
+    } else {
+        ++failures;
+        printf("\nFAIL: %s\n", what);
+    }
+    fflush(stdout);
+}
+
+static int
+write_all(int fd, const unsigned char *data, size_t length)
+{
+    ssize_t result;
+
+    while (length) {
+        if ((result = write(fd, data, length)) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+
+        data += result;
+        length -= result;
+    }
+
+    return 1;
+}
+
+static int
+read_all(int fd, unsigned char *data, size_t length)
+{
+    ssize_t result;
+
+    while (length) {
+        if ((result = read(fd, data, length)) <= 0) {
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+
+        data += result;
+        length -= result;
+    }
+
+    return 1;
+}
+
+/* append a frame header to `frame`; the body length is patched later */
+static size_t
+frame_header(unsigned char *frame, unsigned long id, int op,
+    unsigned int tenant)
+{
+    hashidsd_store_u32(frame, 0);
+    hashidsd_store_u32(frame + 4, id);
+    frame[8] = (unsigned char)op;
+    frame[9] = 0;
+    hashidsd_store_u16(frame + 10, tenant);
+    return HASHIDSD_HEADER_SIZE;
+}
+
+/* read one response; returns its body length, or -1 */
+static long
+read_response(int fd, unsigned char *header, unsigned char *body,
+    size_t capacity)
+{
+    unsigned long length;
+
+    if (!read_all(fd, header, HASHIDSD_HEADER_SIZE)) {
+        return -1;
+    }
+
+    length = hashidsd_load_u32(header);
+    if (length > capacity || !read_all(fd, body, length)) {
+        return -1;
+    }
+
+    return (long)length;
+}
+
+static unsigned long long
+next_random(unsigned long long *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x >> (*x % 64);
+}
+
+/* pipelined batches of encodes, then decodes of the results */
+static int
+test_roundtrip(int fd, unsigned long long seed)
+{
+    static unsigned char request[PIPELINED * 4096], body[1 << 16];
+    static char hashes[PIPELINED][8][512];
+    static unsigned long long numbers[PIPELINED][8][5];
+    unsigned char header[HASHIDSD_HEADER_SIZE], *p;
+    char expected[512];
+    unsigned long long decoded[5];
+    size_t n, i, k, items, count, offset, start, length;
+    long body_length;
+    int op;
+
+    for (op = HASHIDSD_OP_ENCODE; op <= HASHIDSD_OP_DECODE; ++op) {
+        /* PIPELINED frames of 1 to 8 items, sent back to back */
+        for (n = 0, offset = 0; n < PIPELINED; ++n) {
+            start = offset;
+            offset += frame_header(request + offset, n * 2 + op, op,
+                n % TENANTS_COUNT);
+            items = 1 + n % 8;
+            hashidsd_store_u32(request + offset, items);
+            offset += 4;
+
+            for (i = 0; i < items; ++i) {
+                count = 1 + (n + i) % 5;
+
+                if (op == HASHIDSD_OP_ENCODE) {
+                    hashidsd_store_u32(request + offset, count);
+                    offset += 4;
+                    for (k = 0; k < count; ++k, offset += 8) {
+                        numbers[n][i][k] = next_random(&seed);
+                        hashidsd_store_u64(request + offset,
+                            numbers[n][i][k]);
+                    }
+                } else {
+                    length = strlen(hashes[n][i]);
+                    hashidsd_store_u32(request + offset, length);
+                    memcpy(request + offset + 4, hashes[n][i], length);
+                    offset += 4 + length;
+                }
+            }
+
+            hashidsd_store_u32(request + start,
+                offset - start - HASHIDSD_HEADER_SIZE);
+        }
+
+        if (!write_all(fd, request, offset)) {
+            return 0;
+        }
+
+        /* responses come back in order */
+        for (n = 0; n < PIPELINED; ++n) {
+            body_length = read_response(fd, header, body, sizeof(body));
+            if (body_length < 4 || hashidsd_load_u32(header + 4) != n * 2 + op
+                    || header[8] != op || hashidsd_load_u16(header + 10)
+                        != HASHIDSD_STATUS_OK
+                    || hashidsd_load_u32(body) != 1 + n % 8) {
+                return 0;
+            }
+
+            for (i = 0, p = body + 4; i < 1 + n % 8; ++i) {
+                count = 1 + (n + i) % 5;
+
+                if (op == HASHIDSD_OP_ENCODE) {
+                    length = hashidsd_load_u32(p);
+                    hashids_encode(hashids[n % TENANTS_COUNT], expected,
+                        count, numbers[n][i]);
+                    if (length != strlen(expected)
+                            || memcmp(p + 4, expected, length)) {
+                        return 0;
+                    }
+
+                    memcpy(hashes[n][i], p + 4, length);
+                    hashes[n][i][length] = '\0';
+                    p += 4 + length;
+                } else {
+                    if (hashidsd_load_u32(p) != HASHIDS_ERROR_OK
+                            || hashidsd_load_u32(p + 4) != count) {
+                        return 0;
+                    }
+
+                    for (k = 0; k < count; ++k) {
+                        decoded[k] = hashidsd_load_u64(p + 8 + 8 * k);
+                    }
+                    if (memcmp(decoded, numbers[n][i],
+                            count * sizeof(*decoded))) {
+                        return 0;
+                    }
+
+                    p += 8 + 8 * count;
+                }
+            }
+
+            if (p != body + body_length) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* send one frame and read its response */
+static long
+exchange(int fd, int op, unsigned int tenant, const void *payload,
+    size_t payload_length, unsigned char *header, unsigned char *body,
+    size_t capacity)
+{
+    unsigned char request[256];
+    size_t offset;
+
+    offset = frame_header(request, 7, op, tenant);
+    memcpy(request + offset, payload, payload_length);
+    hashidsd_store_u32(request, payload_length);
+
+    if (!write_all(fd, request, offset + payload_length)) {
+        return -1;
+    }
+
+    return read_response(fd, header, body, capacity);
+}
+
+static int
+connect_unix(const char *path)
+{
+    struct sockaddr_un address;
+    int fd, attempt;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    /* the daemon needs a moment to start listening */
+    for (attempt = 0; attempt < 500; ++attempt) {
+        if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+            return -1;
+        }
+        if (!connect(fd, (struct sockaddr *)&address, sizeof(address))) {
+            return fd;
+        }
+
+        close(fd);
+        usleep(10000);
+    }
+
+    return -1;
+}
+
+int
+main(int argc, char **argv)
+{
+    char directory[] = "/tmp/hashidsd-test-XXXXXX", config[64], path[64];
+    unsigned char header[HASHIDSD_HEADER_SIZE], body[256], payload[64];
+    struct stat st;
+    FILE *file;
+    pid_t pid;
+    size_t i;
+    long length;
+    int fd[2], status;
+
+    if (!mkdtemp(directory)) {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+
+    snprintf(config, sizeof(config), "%s/tenants", directory);
+    snprintf(path, sizeof(path), "%s/socket", directory);
+
+    /* configuration */
+    if (!(file = fopen(config, "w"))) {
+        perror(config);
+        return EXIT_FAILURE;
+    }
+
+    fputs("# name, salt, min-length, alphabet\n", file);
+    for (i = 0; i < TENANTS_COUNT; ++i) {
+        fprintf(file, "%s\t%s\t%lu\t%s\n", tenants[i].name, tenants[i].salt,
+            (unsigned long)tenants[i].min_hash_length, tenants[i].alphabet);
+        hashids[i] = hashids_init3(tenants[i].salt,
+            tenants[i].min_hash_length, tenants[i].alphabet);
+    }
+    fclose(file);
+
+    /* the daemon, on two workers */
+    if (!(pid = fork())) {
+        execl("./hashidsd", "hashidsd", "-j", "2", "--cache", "64", "-c",
+            config, path, (char *)NULL);
+        perror("./hashidsd");
+        _exit(127);
+    }
+
+    fd[0] = connect_unix(path);
+    fd[1] = connect_unix(path);
+    check(fd[0] >= 0 && fd[1] >= 0, "connect");
+
+    if (fd[0] >= 0 && fd[1] >= 0) {
+        /* batches, on two connections (and so two workers) */
+        check(test_roundtrip(fd[0], 0x9E3779B97F4A7C15ull), "roundtrip 1");
+        check(test_roundtrip(fd[1], 0x2545F4914F6CDD1Dull), "roundtrip 2");
+        check(test_roundtrip(fd[0], 0x9E3779B97F4A7C15ull),
+            "roundtrip cached");
+
+        /* tenant lookup */
+        length = exchange(fd[0], HASHIDSD_OP_LOOKUP, 0, "salted", 6, header,
+            body, sizeof(body));
+        check(length == 2 && hashidsd_load_u16(header + 10)
+            == HASHIDSD_STATUS_OK && hashidsd_load_u16(body) == 1, "lookup");
+
+        length = exchange(fd[0], HASHIDSD_OP_LOOKUP, 0, "nope", 4, header,
+            body, sizeof(body));
+        check(length == 0 && hashidsd_load_u16(header + 10)
+            == HASHIDSD_STATUS_BAD_TENANT, "lookup unknown");
+
+        /* invalid hashes fail per item */
+        hashidsd_store_u32(payload, 2);
+        hashidsd_store_u32(payload + 4, 3);
+        memcpy(payload + 8, "a!b", 3);
+        hashidsd_store_u32(payload + 11, 2);
+        memcpy(payload + 15, "jR", 2);
+        length = exchange(fd[0], HASHIDSD_OP_DECODE, 0, payload, 17, header,
+            body, sizeof(body));
+        check(length == 4 + 8 + 16
+            && hashidsd_load_u32(body + 4)
+                == ((unsigned long)HASHIDS_ERROR_INVALID_HASH & 0xFFFFFFFFul)
+            && hashidsd_load_u32(body + 8) == 0
+            && hashidsd_load_u32(body + 12) == HASHIDS_ERROR_OK
+            && hashidsd_load_u32(body + 16) == 1
+            && hashidsd_load_u64(body + 20) == 1, "decode invalid item");
+
+        /* bad frames fail as a whole, and the connection goes on */
+        hashidsd_store_u32(payload, 1);
+        hashidsd_store_u32(payload + 4, 2);
+        length = exchange(fd[0], HASHIDSD_OP_ENCODE, 0, payload, 16, header,
+            body, sizeof(body));
+        check(length == 0 && hashidsd_load_u16(header + 10)
+            == HASHIDSD_STATUS_BAD_REQUEST, "truncated item");
+
+        length = exchange(fd[0], HASHIDSD_OP_ENCODE, TENANTS_COUNT, payload,
+            4, header, body, sizeof(body));
+        check(length == 0 && hashidsd_load_u16(header + 10)
+            == HASHIDSD_STATUS_BAD_TENANT, "unknown tenant");
+
+        length = exchange(fd[0], 99, 0, "", 0, header, body, sizeof(body));
+        check(length == 0 && hashidsd_load_u16(header + 10)
+            == HASHIDSD_STATUS_BAD_OP, "unknown op");
+
+        hashidsd_store_u32(payload, 1);
+        hashidsd_store_u32(payload + 4, 1);
+        hashidsd_store_u64(payload + 8, 1);
+        length = exchange(fd[0], HASHIDSD_OP_ENCODE, 0, payload, 16, header,
+            body, sizeof(body));
+        check(length == 4 + 4 + 2 && !memcmp(body + 8, "jR", 2),
+            "after errors");
+
+        close(fd[0]);
+        close(fd[1]);
+    }
+
+    /* clean shutdown */
+    kill(pid, SIGTERM);
+    check(waitpid(pid, &status, 0) == pid && WIFEXITED(status)
+        && WEXITSTATUS(status) == EXIT_SUCCESS, "shutdown");
+    check(stat(path, &st) < 0, "socket removed");
+
+    unlink(config);
+    rmdir(directory);
+    for (i = 0; i < TENANTS_COUNT; ++i) {
+        hashids_free(hashids[i]);
+    }
+
+    printf("\n\n%lu samples, %lu failures\n", (unsigned long)samples,
+        (unsigned long)failures);
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "hashids.h"
+#include "test_gen_a.h"
+#include "test_gen_b.h"
+
+/* the functions of one generated configuration */
+struct generated_t {
+    const char *salt;
+    size_t min_hash_length;
+    const char *alphabet;
+    size_t (*encoded_size)(size_t, const unsigned long long *);
+    size_t (*encode)(char *, size_t, const unsigned long long *);
+    size_t (*numbers_count)(const char *, size_t);
+    size_t (*decode)(const char *, size_t, unsigned long long *);
+};
+
+/* must match the hashids-gen calls in Makefile.am */
+static struct generated_t generated[] = {
+    {"this is my salt", 0, HASHIDS_DEFAULT_ALPHABET,
+        test_gen_a_encoded_size, test_gen_a_encode,
+        test_gen_a_numbers_count, test_gen_a_decode},
+    {"a salt that is longer than the alphabet itself", 30,
+        "0123456789abcdefghijklmnopqrstuvwxyz",
+        test_gen_b_encoded_size, test_gen_b_encode,
+        test_gen_b_numbers_count, test_gen_b_decode}
+};
+
+/* compare a generated configuration with the library on pseudo-random
+   numbers and mangled hashes; returns the number of the failing sample or 0 */
+static size_t
+compare(struct generated_t *g, unsigned long long x)
+{
+    hashids_t *hashids;
+    unsigned long long numbers[5], expected_numbers[8], decoded[8];
+    char expected[512], hash[512];
+    size_t i, k, count, length, result;
+
+    hashids = hashids_init3(g->salt, g->min_hash_length, g->alphabet);
+    if (!hashids) {
+        return 1;
+    }
+
+    for (i = 1; i <= 20000; ++i) {
+        count = 1 + i % 5;
+        for (k = 0; k < count; ++k) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            numbers[k] = x >> (x % 64);
+        }
+
+        /* encoding */
+        length = hashids_encode(hashids, expected, count, numbers);
+        if (g->encode(hash, count, numbers) != length
+                || g->encoded_size(count, numbers) != length
+                || strcmp(hash, expected)) {
+            break;
+        }
+
+        /* decoding, also of mangled hashes */
+        if (i % 2) {
+            hash[x % length] = g->alphabet[x % strlen(g->alphabet)];
+        }
+        length = hashids_numbers_count_n(hashids, hash, strlen(hash));
+        if (g->numbers_count(hash, strlen(hash)) != length) {
+            break;
+        }
+        if (length > 5) {
+            continue;
+        }
+
+        /* a separator taken for the lottery leaves the last slot
+           unwritten */
+        memset(expected_numbers, 0, sizeof(expected_numbers));
+        memset(decoded, 0, sizeof(decoded));
+        length = hashids_decode_n(hashids, hash, strlen(hash),
+            expected_numbers);
+        result = g->decode(hash, strlen(hash), decoded);
+        if (result != length || memcmp(decoded, expected_numbers,
+                length * sizeof(*decoded))) {
+            break;
+        }
+    }
+
+    hashids_free(hashids);
+    return i <= 20000 ? i : 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t i, j, failures = 0;
+
+    for (i = 0; i < sizeof(generated) / sizeof(generated[0]); ++i) {
+        if ((j = compare(&generated[i], 0x9E3779B97F4A7C15ull + i))) {
+            printf("F\nconfiguration %lu differs at sample %lu\n",
+                (unsigned long)i, (unsigned long)j);
+            ++failures;
+        } else {
+            printf(".");
+        }
+    }
+
+    printf("\n\n%lu samples, %lu failures\n", (unsigned long)i,
+        (unsigned long)failures);
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,254 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "hashids.hpp"
+
+static std::size_t samples, failures;
+
+static void
+check(bool ok, const char *what)
+{
+    ++samples;
+    if (ok) {
+        std::printf(".");
+    } else {
+        ++failures;
+        std::printf("\nFAIL: %s\n", what);
+    }
+    std::fflush(stdout);
+}
+
+/* encode/decode a few numbers per thread against one shared encoder */
+static void
+worker(const hashids::encoder *encoder, std::uint64_t seed, bool *ok)
+{
+    std::uint64_t numbers[3], decoded[3];
+    char buffer[64];
+
+    for (std::uint64_t i = 0; i < 20000; ++i) {
+        numbers[0] = seed + i;
+        numbers[1] = i * 2654435761ull;
+        numbers[2] = ~i;
+
+        auto encoded = encoder->encode(numbers, 3, buffer, sizeof(buffer));
+        auto result = encoder->decode(
+            std::string_view(buffer, encoded.size), decoded, 3);
+
+        if (!encoded || !result || result.size != 3
+                || decoded[0] != numbers[0] || decoded[1] != numbers[1]
+                || decoded[2] != numbers[2]) {
+            *ok = false;
+            return;
+        }
+    }
+
+    *ok = true;
+}
+
+#if __cplusplus >= 202002L
+/* compare a static_encoder with the C library on pseudo-random input */
+template <class Static>
+static bool
+compare(const char *salt, const char *alphabet)
+{
+    hashids_t *hashids = hashids_init3(salt, Static::min_hash_length,
+        alphabet);
+    std::uint64_t numbers[5], decoded[8], x = 0x9E3779B97F4A7C15ull;
+    unsigned long long expected_numbers[8];
+    char expected[512], hash[512];
+    bool ok = hashids != nullptr;
+
+    for (std::size_t i = 0; ok && i < 5000; ++i) {
+        std::size_t count = 1 + i % 5, length;
+
+        for (std::size_t k = 0; k < count; ++k) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            numbers[k] = x >> (x % 64);
+            expected_numbers[k] = numbers[k];
+        }
+
+        /* encoding */
+        length = hashids_encode(hashids, expected, count, expected_numbers);
+        auto encoded = Static::encode(numbers, count, hash, sizeof(hash));
+        ok = encoded && encoded.size == length
+            && Static::encoded_size(numbers, count) == length
+            && !std::memcmp(hash, expected, length + 1);
+
+        /* decoding, also of mangled hashes */
+        if (i % 2) {
+            hash[x % length] = alphabet[x % std::strlen(alphabet)];
+        }
+        hashids_errno = HASHIDS_ERROR_OK;
+        length = hashids_numbers_count_n(hashids, hash, std::strlen(hash));
+        if (ok && length <= 5) {
+            /* a separator taken for the lottery leaves the last slot
+               unwritten, a guard makes hashids_decode_n() write past the
+               count */
+            std::memset(decoded, 0, sizeof(decoded));
+            std::memset(expected_numbers, 0, sizeof(expected_numbers));
+
+            auto result = Static::decode(hash, decoded, 5);
+
+            if (length) {
+                length = hashids_decode_n(hashids, hash, std::strlen(hash),
+                    expected_numbers);
+            }
+            ok = result.size == length
+                && result.error == static_cast<hashids::errc>(hashids_errno)
+                && (!length || !std::memcmp(decoded, expected_numbers,
+                    length * sizeof(*decoded)));
+        }
+    }
+
+    hashids_free(hashids);
+    return ok;
+}
+#endif
+
+int
+main()
+{
+    const std::uint64_t numbers[] = {683, 94108, 123, 5};
+    std::uint64_t decoded[4];
+    char buffer[32];
+
+    /* encoding */
+    hashids::encoder plain;
+    check(plain.encode({1}) == "jR", "encode {1}");
+    check(plain.encode(numbers, 4) == "vJvi7On9cXGtD", "encode pointer");
+    check(plain.encode({}) == "", "encode {}");
+
+    hashids::encoder salted("Arbitrary string");
+    check(salted.encode({683, 94108, 123, 5}) == "QWyf8yboH7KT2",
+        "encode salted");
+
+    hashids::encoder padded("", 25);
+    check(padded.encode({1, 2, 3}) == "gyOwl4B97bo2fXhVaDR0Znjrq",
+        "encode min_hash_length");
+
+    /* caller buffers */
+    auto result = plain.encode(numbers, 4, buffer, sizeof(buffer));
+    check(result && result.size == 13
+        && std::string(buffer) == "vJvi7On9cXGtD", "encode buffer");
+
+    result = plain.encode(numbers, 4, buffer, 13);
+    check(result && std::string(buffer, 13) == "vJvi7On9cXGtD",
+        "encode exact buffer");
+
+    result = plain.encode(numbers, 4, buffer, 12);
+    check(result.error == hashids::errc::overflow && result.size == 13,
+        "encode short buffer");
+
+    /* output iterators */
+    std::string out = "id:";
+    plain.encode(numbers, 4, std::back_inserter(out));
+    check(out == "id:vJvi7On9cXGtD", "encode iterator");
+
+    /* decoding from views that are not NUL-terminated */
+    std::string_view text = "vJvi7On9cXGtD,rest";
+    result = plain.decode(text.substr(0, 13), decoded, 4);
+    check(result && result.size == 4 && decoded[0] == 683
+        && decoded[1] == 94108 && decoded[2] == 123 && decoded[3] == 5,
+        "decode view");
+
+    result = plain.decode(text.substr(0, 13), decoded, 3);
+    check(result.error == hashids::errc::overflow && result.size == 4,
+        "decode short buffer");
+
+    result = plain.decode("a!b", decoded, 4);
+    check(result.error == hashids::errc::invalid_hash, "decode invalid");
+
+    check(plain.decode("o2fXhV") == std::vector<std::uint64_t>{1, 2, 3},
+        "decode vector");
+
+    try {
+        plain.decode("a!b");
+        check(false, "decode throws");
+    } catch (const std::system_error &e) {
+        check(e.code() == hashids::errc::invalid_hash, "decode throws");
+    }
+
+    /* errors */
+    try {
+        hashids::encoder bad("", 0, "abc");
+        check(false, "short alphabet throws");
+    } catch (const std::system_error &e) {
+        check(e.code() == hashids::errc::alphabet_length,
+            "short alphabet throws");
+    }
+
+#if __cplusplus >= 202002L
+    /* spans */
+    std::span<const std::uint64_t> span(numbers);
+    result = plain.encode(span, std::span<char>(buffer));
+    check(result && std::string(buffer) == "vJvi7On9cXGtD", "encode span");
+
+    result = plain.decode("vJvi7On9cXGtD", std::span<std::uint64_t>(decoded));
+    check(result && result.size == 4 && decoded[1] == 94108, "decode span");
+
+    check(plain.encode(span.first(1)) == "6VN", "encode span string");
+
+    /* compile-time encoders */
+    using plain_static = hashids::static_encoder<"">;
+    static_assert(plain_static::constant<1> == "jR");
+    static_assert(plain_static::constant<683, 94108, 123, 5>
+        == "vJvi7On9cXGtD");
+    static_assert(plain_static::constant<> == "");
+    static_assert(hashids::static_encoder<"", HASHIDS_DEFAULT_ALPHABET, 25>
+        ::constant<1, 2, 3> == "gyOwl4B97bo2fXhVaDR0Znjrq");
+    static_assert(hashids::static_encoder<"arbitrary salt",
+        "abcdefghijklmnopqrstuvwxyz", 16>::constant<60125>
+        == "jkbgxljrjxmlaonp");
+
+    check(plain_static::encode({683, 94108, 123, 5}) == "vJvi7On9cXGtD",
+        "static encode");
+    check(plain_static::decode("o2fXhV") == std::vector<std::uint64_t>{1, 2,
+        3}, "static decode");
+    result = plain_static::decode("a!b", decoded, 4);
+    check(result.error == hashids::errc::invalid_hash,
+        "static decode invalid");
+
+    check(compare<plain_static>("", HASHIDS_DEFAULT_ALPHABET),
+        "static vs C: defaults");
+    check(compare<hashids::static_encoder<"this is my salt",
+        HASHIDS_DEFAULT_ALPHABET, 8>>("this is my salt",
+        HASHIDS_DEFAULT_ALPHABET), "static vs C: salt, min 8");
+    check(compare<hashids::static_encoder<"a salt that is longer than the "
+        "whole alphabet of sixty-two characters, which truncates the salt",
+        "abcdefghijklmnopqrstuvwxyz", 40>>("a salt that is longer than the "
+        "whole alphabet of sixty-two characters, which truncates the salt",
+        "abcdefghijklmnopqrstuvwxyz"), "static vs C: long salt, min 40");
+    check(compare<hashids::static_encoder<"salt", "cfhistuCFHISTUab", 20>>(
+        "salt", "cfhistuCFHISTUab"), "static vs C: separator alphabet");
+    check(compare<hashids::static_encoder<"x", "0123456789abcdef", 3>>(
+        "x", "0123456789abcdef"), "static vs C: hex alphabet");
+#endif
+
+    /* one encoder shared by several threads */
+    bool ok[4];
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < 4; ++i) {
+        threads.emplace_back(worker, &salted, i << 40, &ok[i]);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    check(ok[0] && ok[1] && ok[2] && ok[3], "shared across threads");
+
+    /* moves */
+    hashids::encoder moved(std::move(salted));
+    check(moved.encode({1, 2, 3}) == "neHrCa", "moved encoder");
+
+    std::printf("\n\n%lu samples, %lu failures\n",
+        (unsigned long)samples, (unsigned long)failures);
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
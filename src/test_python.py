@@ -0,0 +1,114 @@
+import array
+import sys
+import threading
+
+import chashids
+
+samples = failures = 0
+
+
+def check(ok, what):
+    global samples, failures
+    samples += 1
+    if ok:
+        sys.stdout.write(".")
+    else:
+        failures += 1
+        sys.stdout.write("\nFAIL: %s\n" % what)
+    sys.stdout.flush()
+
+
+def raises(exception, function, *args, **kwargs):
+    try:
+        function(*args, **kwargs)
+    except exception:
+        return True
+    return False
+
+
+plain = chashids.Hashids()
+salted = chashids.Hashids("this is my salt")
+padded = chashids.Hashids(min_length=25)
+hex = chashids.Hashids("x", 3, "0123456789abcdef")
+
+# single calls
+check(plain.encode(1) == "jR", "encode 1")
+check(plain.encode(683, 94108, 123, 5) == "vJvi7On9cXGtD", "encode tuple")
+check(salted.encode(1, 2, 3) == "laHquq", "encode salted")
+check(padded.encode(1, 2, 3) == "gyOwl4B97bo2fXhVaDR0Znjrq", "encode padded")
+check(plain.encode() == "", "encode nothing")
+check(plain.encode(2 ** 64 - 1) == plain.encode_batch(
+    array.array("Q", [2 ** 64 - 1]))[0], "encode max")
+check(salted.decode("laHquq") == (1, 2, 3), "decode")
+check(salted.decode(b"laHquq") == (1, 2, 3), "decode bytes")
+check(plain.decode("a!b") == (), "decode invalid")
+check(raises(OverflowError, plain.encode, -1), "encode negative")
+check(raises(ValueError, chashids.Hashids, "", 0, "abc"), "short alphabet")
+check(raises(ValueError, chashids.Hashids, "", 0, "abcdefghijklmnopé"),
+    "non-ASCII alphabet")
+
+# batches of single numbers
+numbers = array.array("Q", range(100000))
+hashes = salted.encode_batch(numbers)
+check(len(hashes) == 100000 and hashes[1] == salted.encode(1)
+    and hashes[99999] == salted.encode(99999), "encode_batch")
+check(hashes == salted.encode_batch(numbers, threads=4), "encode_batch threads")
+check(hashes == salted.encode_batch(memoryview(numbers)), "memoryview")
+check(hashes == salted.encode_batch(array.array("q", range(100000))),
+    "signed buffer")
+
+decoded = salted.decode_batch(hashes)
+check(isinstance(decoded, array.array) and decoded == numbers, "decode_batch")
+check(salted.decode_batch(hashes, threads=0) == numbers,
+    "decode_batch threads")
+
+out = bytearray(8 * 100000)
+result = salted.decode_batch(hashes, out=memoryview(out).cast("Q"))
+check(memoryview(out).cast("Q").tolist() == numbers.tolist(),
+    "decode_batch out")
+
+# tuples
+pairs = array.array("Q", [i * 7919 % 2 ** 64 for i in range(20000)])
+hashes = hex.encode_batch(pairs, arity=2, threads=3)
+check(len(hashes) == 10000 and hashes[3] == hex.encode(pairs[6], pairs[7]),
+    "encode_batch arity")
+check(hex.decode_batch(hashes, arity=2, threads=3) == pairs,
+    "decode_batch arity")
+check(raises(ValueError, hex.encode_batch, pairs[:3], arity=2),
+    "arity mismatch")
+
+# invalid hashes
+check(raises(ValueError, plain.decode_batch, ["jR", "a!b"]), "strict")
+check(plain.decode_batch(["jR", "a!b", "jR"], strict=False)
+    == array.array("Q", [1, 0, 1]), "not strict")
+check(raises(ValueError, plain.decode_batch, ["jR"], arity=2), "wrong arity")
+check(raises(OverflowError, plain.decode_batch, ["abc"] * 4, arity=2 ** 62,
+    out=array.array("Q", [0]), strict=False), "decode_batch arity overflow")
+check(raises(OverflowError, plain.encode_batch, array.array("Q", [1, 2]),
+    arity=2 ** 62), "encode_batch arity overflow")
+check(plain.encode_batch(array.array("Q"), arity=2 ** 59) == [],
+    "encode_batch nothing, large arity")
+check(raises(TypeError, plain.decode_batch, [1]), "not a string")
+check(raises(TypeError, plain.encode_batch, array.array("I", [1])),
+    "32-bit buffer")
+check(raises(TypeError, plain.encode_batch, [1, 2]), "not a buffer")
+check(raises(ValueError, plain.decode_batch, ["jR", "jR"],
+    out=array.array("Q", [0])), "out too small")
+
+# the GIL is released: batches run next to each other
+results = [None] * 4
+
+
+def work(i):
+    results[i] = salted.decode_batch(salted.encode_batch(numbers))
+
+
+threads = [threading.Thread(target=work, args=(i,)) for i in range(4)]
+for thread in threads:
+    thread.start()
+for thread in threads:
+    thread.join()
+check(all(result == numbers for result in results), "python threads")
+
+print("\n\n%d samples, %d failures" % (samples, failures))
+sys.exit(1 if failures else 0)
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sqlite3.h>
+
+#include "hashids.h"
+
+/* sqlite.c, linked in (SQLITE_CORE) */
+int
+sqlite3_hashids_init(sqlite3 *db, char **error,
+    const sqlite3_api_routines *api);
+
+static size_t samples, failures;
+
+/* the first column of the first row as text, "NULL", or "error: ..." */
+static const char *
+query(sqlite3 *db, const char *sql)
+{
+    static char result[512];
+    sqlite3_stmt *stmt;
+    int rc;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        snprintf(result, sizeof(result), "error: %s", sqlite3_errmsg(db));
+        return result;
+    }
+
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        snprintf(result, sizeof(result), "%s",
+            sqlite3_column_type(stmt, 0) == SQLITE_NULL ? "NULL"
+                : (const char *)sqlite3_column_text(stmt, 0));
+    } else if (rc == SQLITE_DONE) {
+        snprintf(result, sizeof(result), "no rows");
+    } else {
+        snprintf(result, sizeof(result), "error: %s", sqlite3_errmsg(db));
+    }
+
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+static void
+check(sqlite3 *db, const char *sql, const char *expected)
+{
+    const char *result = query(db, sql);
+
+    ++samples;
+    if (!strcmp(result, expected)) {
+        printf(".");
+    } else {
+        ++failures;
+        printf("\nFAIL: %s\n  expected: %s\n  got: %s\n", sql, expected,
+            result);
+    }
+    fflush(stdout);
+}
+
+int
+main(int argc, char **argv)
+{
+    sqlite3 *db;
+    hashids_t *hashids;
+    char sql[512], hash[64];
+    unsigned long long number = 987654321ull;
+
+    if (sqlite3_open(":memory:", &db) != SQLITE_OK
+            || sqlite3_hashids_init(db, NULL, NULL) != SQLITE_OK) {
+        puts("cannot initialize the extension");
+        return EXIT_FAILURE;
+    }
+
+    /* encoding */
+    check(db, "SELECT hashids_encode('', 1)", "jR");
+    check(db, "SELECT hashids_encode('', 683, 94108, 123, 5)",
+        "vJvi7On9cXGtD");
+    check(db, "SELECT hashids_encode('this is my salt', 1, 2, 3)", "laHquq");
+    check(db, "SELECT hashids_encode('')", "");
+    check(db, "SELECT hashids_encode3('', 25, '" HASHIDS_DEFAULT_ALPHABET
+        "', 1, 2, 3)", "gyOwl4B97bo2fXhVaDR0Znjrq");
+    check(db, "SELECT hashids_encode(NULL, 1)", "NULL");
+    check(db, "SELECT hashids_encode('', 1, NULL)", "NULL");
+    check(db, "SELECT hashids_encode('', 'x')",
+        "error: hashids_encode: numbers must be integers");
+    check(db, "SELECT hashids_encode3('', 0, 'abc', 1)",
+        "error: hashids_encode: alphabet is too short");
+    check(db, "SELECT hashids_encode3('', 0)",
+        "error: hashids_encode3: missing settings");
+
+    hashids = hashids_init("this is my salt");
+    hashids_encode_one(hashids, hash, number);
+    snprintf(sql, sizeof(sql),
+        "SELECT hashids_encode('this is my salt', %llu)", number);
+    check(db, sql, hash);
+    hashids_free(hashids);
+
+    /* decoding */
+    check(db, "SELECT group_concat(value) FROM "
+        "hashids_decode('this is my salt', 'laHquq')", "1,2,3");
+    check(db, "SELECT group_concat(idx) FROM "
+        "hashids_decode('this is my salt', 'laHquq')", "0,1,2");
+    check(db, "SELECT value FROM hashids_decode('', "
+        "'gyOwl4B97bo2fXhVaDR0Znjrq', 25) WHERE idx = 2", "3");
+    check(db, "SELECT count(*) FROM hashids_decode('', 'a!b')", "0");
+    check(db, "SELECT count(*) FROM hashids_decode('', NULL)", "0");
+    check(db, "SELECT value FROM hashids_decode('', hashids_encode('', -1))",
+        "-1");
+    check(db, "SELECT count(*) FROM hashids_decode('', 'jR', 0, 'abc')",
+        "error: hashids_decode: alphabet is too short");
+    check(db, "SELECT count(*) FROM hashids_decode",
+        "error: hashids_decode: needs a salt and a hash");
+
+    /* a table scan, with per-row salts and constant ones */
+    check(db, "CREATE TABLE t(id INTEGER PRIMARY KEY, salt TEXT, hash TEXT)",
+        "no rows");
+    check(db, "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 "
+        "FROM n WHERE i < 20000) INSERT INTO t SELECT i, 'salt ' || (i % 3), "
+        "hashids_encode('salt ' || (i % 3), i) FROM n", "no rows");
+    check(db, "SELECT count(*) FROM t, hashids_decode(t.salt, t.hash) d "
+        "WHERE d.value = t.id", "20000");
+    check(db, "SELECT count(*) FROM t WHERE salt = 'salt 1' "
+        "AND hash = hashids_encode('salt 1', id)", "6667");
+    check(db, "SELECT hash FROM t WHERE id = 1", "4k");
+
+    sqlite3_close(db);
+
+    printf("\n\n%lu samples, %lu failures\n", (unsigned long)samples,
+        (unsigned long)failures);
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
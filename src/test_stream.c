@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "hashids.h"
+
+#define SALT "this is my salt"
+
+/* records longer than the 1MiB streaming block, then a short one */
+static const struct {
+    size_t length;
+    char fill;
+    unsigned long long number;
+} records[] = {
+    {2500000, 'x', 5},
+    {2000000, 'y', 6},
+    {2, '4', 7},
+    {3 << 20, 'z', 8},
+    {1, 'w', 9}
+};
+
+#define RECORDS_COUNT (sizeof(records) / sizeof(records[0]))
+
+static size_t samples, failures;
+
+static void
+check(int ok, const char *what)
+{
+    ++samples;
+    if (ok) {
+        printf(".");
+    } else {
+        ++failures;
+        printf("\nFAIL: %s\n", what);
+    }
+    fflush(stdout);
+}
+
+static int
+write_all(int fd, const char *data, size_t length)
+{
+    ssize_t result;
+
+    while (length) {
+        if ((result = write(fd, data, length)) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+
+        data += result;
+        length -= result;
+    }
+
+    return 1;
+}
+
+/* build "<fill...>,<number>\n" records, or the expected column 2 output */
+static size_t
+build(char *data, hashids_t *hashids)
+{
+    size_t i, length = 0;
+
+    for (i = 0; i < RECORDS_COUNT; ++i) {
+        memset(data + length, records[i].fill, records[i].length);
+        length += records[i].length;
+        data[length++] = ',';
+        if (hashids) {
+            length += hashids_encode_one(hashids, data + length,
+                records[i].number);
+        } else {
+            length += sprintf(data + length, "%llu", records[i].number);
+        }
+        data[length++] = '\n';
+    }
+
+    return length;
+}
+
+/* a temporary file holding `length` bytes of `data`, rewound */
+static int
+temporary(const char *data, size_t length)
+{
+    char path[] = "/tmp/hashids-stream-test-XXXXXX";
+    int fd;
+
+    if ((fd = mkstemp(path)) < 0) {
+        return -1;
+    }
+    unlink(path);
+
+    if (!write_all(fd, data, length) || lseek(fd, 0, SEEK_SET) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/* run `input` through ./hashids --column 2 on `jobs` threads; stdin is a
+   regular file so reads fill whole blocks, carrying long partial records */
+static int
+run(const char *jobs, const char *input, size_t input_length, char *output,
+    size_t *output_length, size_t capacity)
+{
+    pid_t pid;
+    ssize_t result;
+    int in, out, status, ok;
+
+    if ((in = temporary(input, input_length)) < 0) {
+        return 0;
+    }
+
+    if ((out = temporary("", 0)) < 0) {
+        close(in);
+        return 0;
+    }
+
+    if (!(pid = fork())) {
+        dup2(in, STDIN_FILENO);
+        dup2(out, STDOUT_FILENO);
+        execl("./hashids", "hashids", "-j", jobs, "-s", SALT, "--column",
+            "2", (char *)NULL);
+        perror("./hashids");
+        _exit(127);
+    }
+
+    ok = waitpid(pid, &status, 0) == pid && WIFEXITED(status)
+        && WEXITSTATUS(status) == EXIT_SUCCESS;
+
+    *output_length = 0;
+    lseek(out, 0, SEEK_SET);
+    while ((result = read(out, output + *output_length,
+            capacity - *output_length)) > 0) {
+        *output_length += result;
+    }
+    close(in);
+    close(out);
+
+    return ok && result == 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    static const char *jobs[] = {"1", "2", "3"};
+    hashids_t *hashids;
+    char *input, *expected, *output, what[32];
+    size_t i, capacity = 0, input_length, expected_length, output_length;
+
+    (void)argc;
+    (void)argv;
+
+    for (i = 0; i < RECORDS_COUNT; ++i) {
+        capacity += records[i].length + 64;
+    }
+
+    hashids = hashids_init(SALT);
+    input = malloc(capacity);
+    expected = malloc(capacity);
+    output = malloc(capacity);
+    if (!hashids || !input || !expected || !output) {
+        fputs("Out of memory\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    input_length = build(input, NULL);
+    expected_length = build(expected, hashids);
+
+    for (i = 0; i < sizeof(jobs) / sizeof(jobs[0]); ++i) {
+        snprintf(what, sizeof(what), "-j %s", jobs[i]);
+        check(run(jobs[i], input, input_length, output, &output_length,
+            capacity) && output_length == expected_length
+            && !memcmp(output, expected, expected_length), what);
+    }
+
+    hashids_free(hashids);
+    free(input);
+    free(expected);
+    free(output);
+
+    printf("\n\n%lu samples, %lu failures\n", (unsigned long)samples,
+        (unsigned long)failures);
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}